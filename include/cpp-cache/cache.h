@@ -5,9 +5,18 @@
 #ifndef CPP_CACHE_CACHE_H_
 #define CPP_CACHE_CACHE_H_
 
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <limits>
 #include <mutex>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
+#include <vector>
+
+#include "policy/none.h"
 
 namespace cpp_cache
 {
@@ -21,7 +30,129 @@ namespace cpp_cache
     inline void unlock() { }
   };
 
-  template<class Key, class T, class CachingPolicy, class StoragePolicy, class LockingPolicy = no_locking>
+  // readers-writer lock allowing any number of threads to share the lock for
+  // reading (lock_shared()) while writing (lock()) is exclusive. threads
+  // waiting to write block new readers so that they don't starve.
+  class shared_locking
+  {
+  public:
+    shared_locking()
+      : mutex_()
+      , readers_cv_()
+      , writers_cv_()
+      , readers_(0)
+      , waiting_writers_(0)
+      , writer_(false)
+    { }
+
+    shared_locking(const shared_locking&) = delete;
+    shared_locking& operator=(const shared_locking&) = delete;
+
+    ~shared_locking() = default;
+
+    void lock()
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      ++waiting_writers_;
+      writers_cv_.wait(lock, [this]() { return !writer_ && readers_ == 0; });
+      --waiting_writers_;
+
+      writer_ = true;
+    }
+
+    void unlock()
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      writer_ = false;
+      if (waiting_writers_ > 0)
+        writers_cv_.notify_one();
+      else
+        readers_cv_.notify_all();
+    }
+
+    void lock_shared()
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      readers_cv_.wait(lock, [this]() { return !writer_ && waiting_writers_ == 0; });
+      ++readers_;
+    }
+
+    void unlock_shared()
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      if (--readers_ == 0 && waiting_writers_ > 0)
+        writers_cv_.notify_one();
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable readers_cv_;
+    std::condition_variable writers_cv_;
+    size_t readers_;
+    size_t waiting_writers_;
+    bool writer_;
+  };
+
+  // weigher treating every cached value the same so that the weight of a
+  // cache is its number of cached values
+  struct unweighted
+  {
+    template<class Key, class T>
+    inline size_t operator()(const Key&, const T&) const { return 1; }
+  };
+
+namespace detail
+{
+  // storage policies defining stored_in_caching_policy leave storing the
+  // values to the caching policy (see storage::entry)
+  template<class StoragePolicy, class = void>
+  struct stored_in_caching_policy : std::false_type
+  { };
+
+  template<class StoragePolicy>
+  struct stored_in_caching_policy<StoragePolicy, typename std::enable_if<StoragePolicy::stored_in_caching_policy>::type> : std::true_type
+  { };
+
+  // locking policies providing lock_shared() and unlock_shared()
+  template<class LockingPolicy, class = void>
+  struct shared_lockable : std::false_type
+  { };
+
+  template<class LockingPolicy>
+  struct shared_lockable<LockingPolicy, decltype(std::declval<LockingPolicy&>().lock_shared(), std::declval<LockingPolicy&>().unlock_shared())> : std::true_type
+  { };
+
+  template<class LockingPolicy>
+  class shared_lock_guard
+  {
+  public:
+    explicit shared_lock_guard(LockingPolicy& lock)
+      : lock_(lock)
+    {
+      lock_.lock_shared();
+    }
+
+    shared_lock_guard(const shared_lock_guard&) = delete;
+    shared_lock_guard& operator=(const shared_lock_guard&) = delete;
+
+    ~shared_lock_guard()
+    {
+      lock_.unlock_shared();
+    }
+
+  private:
+    LockingPolicy& lock_;
+  };
+}
+
+  // the weigher determines the weight of every cached value (e.g. its size in
+  // bytes). on top of the limits of the caching policy keys are expired until
+  // the total weight of all cached values fits into the maximum weight.
+  template<class Key, class T, class CachingPolicy, class StoragePolicy, class LockingPolicy = no_locking, class Weigher = unweighted>
   class cache : public CachingPolicy, protected StoragePolicy
   {
   public:
@@ -30,8 +161,35 @@ namespace cpp_cache
     using caching_policy = CachingPolicy;
     using storage_policy = StoragePolicy;
     using locking_policy = LockingPolicy;
+    using weigher = Weigher;
+    using weight_type = size_t;
+
+  private:
+    // the policy actually storing the cached values
+    static constexpr bool stored_in_caching_policy = detail::stored_in_caching_policy<storage_policy>::value;
+    using storage_provider = typename std::conditional<stored_in_caching_policy, caching_policy, storage_policy>::type;
+
+    // without a weigher the weight is the size of the caching policy and doesn't have to be tracked
+    static constexpr bool weighted = !std::is_same<weigher, unweighted>::value;
+
+    // reading from the cache only needs a shared lock if the caching policy and the locking policy support it
+    using read_lock = typename std::conditional<detail::shared_reads<caching_policy>::value && detail::shared_lockable<locking_policy>::value,
+      detail::shared_lock_guard<locking_policy>, std::lock_guard<locking_policy>>::type;
 
-    explicit cache() = default;
+  public:
+    // all arguments are passed on to the caching policy (e.g. the maximum size
+    // of a caching policy with a dynamic size)
+    template<typename... CachingPolicyArgs>
+    explicit cache(CachingPolicyArgs&&... args)
+      : caching_policy(std::forward<CachingPolicyArgs>(args)...)
+      , storage_policy()
+      , expired_keys_()
+      , weigher_()
+      , weight_(0)
+      , max_weight_(std::numeric_limits<weight_type>::max())
+      , loads_()
+      , lock_()
+    { }
 
     ~cache()
     {
@@ -40,7 +198,7 @@ namespace cpp_cache
 
     typename caching_policy::size_type size() const
     {
-      std::lock_guard<locking_policy> lock(lock_);
+      read_lock lock(lock_);
 
       // first expire elements if necessary
       expire();
@@ -50,7 +208,7 @@ namespace cpp_cache
 
     bool empty() const
     {
-      std::lock_guard<locking_policy> lock(lock_);
+      read_lock lock(lock_);
 
       // first expire elements if necessary
       expire();
@@ -58,123 +216,402 @@ namespace cpp_cache
       return caching_policy::empty();
     }
 
-    bool has(const key_type& key) const
+    weight_type weight() const
+    {
+      read_lock lock(lock_);
+
+      // first expire elements if necessary
+      expire();
+
+      return weight_internal();
+    }
+
+    weight_type max_weight() const
+    {
+      read_lock lock(lock_);
+
+      return max_weight_;
+    }
+
+    // changes the maximum weight and expires keys one after the other until
+    // the total weight fits into it
+    void set_max_weight(weight_type max_weight)
     {
       std::lock_guard<locking_policy> lock(lock_);
 
       // first expire elements if necessary
       expire();
 
+      max_weight_ = max_weight;
+      while (weight_internal() > max_weight_ && caching_policy::evict_key(expired_keys_))
+        expire_from_storage();
+    }
+
+    bool has(const key_type& key) const
+    {
+      read_lock lock(lock_);
+
+      // first expire elements if necessary
+      expire();
+
       return has_internal(key);
     }
 
     const cached_type& get(const key_type& key) const
     {
-      std::lock_guard<locking_policy> lock(lock_);
+      read_lock lock(lock_);
 
-      return get_internal(key);
+      const cached_type* value = find_internal(key);
+      if (value == nullptr)
+        throw std::out_of_range("element not present in the cache");
+
+      return *value;
     }
 
     bool try_get(const key_type& key, cached_type& value) const
+    {
+      read_lock lock(lock_);
+
+      const cached_type* cached_value = find_internal(key);
+      if (cached_value == nullptr)
+        return false;
+
+      value = *cached_value;
+      return true;
+    }
+
+    // returns a pointer to the cached value or nullptr if the key isn't
+    // cached. the pointer is only valid until the cache is modified.
+    const cached_type* find(const key_type& key) const
+    {
+      read_lock lock(lock_);
+
+      return find_internal(key);
+    }
+
+    bool touch(const key_type& key)
+    {
+      read_lock lock(lock_);
+
+      // first expire elements if necessary
+      expire();
+
+      return caching_policy::touch_key(key);
+    }
+
+    // returns false if the value is heavier than the maximum weight and
+    // therefore can't be cached
+    template<typename... CachingPolicyArgs>
+    bool insert(const key_type& key, const cached_type& value, CachingPolicyArgs&&... args)
     {
       std::lock_guard<locking_policy> lock(lock_);
 
-      try
+      return insert_internal(key, value, std::forward<CachingPolicyArgs>(args)...);
+    }
+
+    // looks up all keys in [first, last) and writes a pair of the key and its
+    // cached value to out for every cached key. returns the number of cached
+    // keys. the lock is only taken once for all keys.
+    template<class KeyIterator, class OutputIterator>
+    size_t get_many(KeyIterator first, KeyIterator last, OutputIterator out) const
+    {
+      read_lock lock(lock_);
+
+      // first expire elements if necessary
+      expire();
+
+      size_t found = 0;
+      for (; first != last; ++first)
       {
-        value = get_internal(key);
+        const cached_type* value = lookup(*first);
+        if (value == nullptr)
+          continue;
+
+        *out++ = std::pair<key_type, cached_type>(*first, *value);
+        ++found;
       }
-      catch (std::out_of_range&)
+
+      return found;
+    }
+
+    // inserts all pairs of keys and values in [first, last) passing the same
+    // arguments to the caching policy for every key. returns the number of
+    // inserted values. the lock is only taken once for all keys.
+    template<class InputIterator, typename... CachingPolicyArgs>
+    size_t insert_many(InputIterator first, InputIterator last, CachingPolicyArgs&&... args)
+    {
+      std::lock_guard<locking_policy> lock(lock_);
+
+      // first expire elements if necessary
+      expire();
+
+      size_t inserted = 0;
+      for (; first != last; ++first)
       {
-        return false;
+        if (store(first->first, first->second, args...))
+          ++inserted;
       }
 
-      return true;
+      return inserted;
     }
 
-    bool touch(const key_type& key)
+    // returns the cached value or calls loader(key) to load and insert it on a
+    // miss. the loader is called without holding the lock and only once for
+    // all threads missing the same key at the same time. all of them get the
+    // loaded value or the exception thrown by the loader.
+    template<class Loader, typename... CachingPolicyArgs>
+    cached_type get_or_load(const key_type& key, Loader&& loader, CachingPolicyArgs&&... args)
+    {
+      std::unique_lock<locking_policy> lock(lock_);
+
+      const cached_type* cached_value = find_internal(key);
+      if (cached_value != nullptr)
+        return *cached_value;
+
+      // wait for the result of a load which is already in flight
+      for (const auto& load : loads_)
+      {
+        if (load.first == key)
+        {
+          std::shared_future<cached_type> result = load.second;
+          lock.unlock();
+
+          return result.get();
+        }
+      }
+
+      std::promise<cached_type> promise;
+      loads_.emplace_back(key, promise.get_future().share());
+      lock.unlock();
+
+      try
+      {
+        cached_type value = loader(key);
+
+        lock.lock();
+        insert_internal(key, value, std::forward<CachingPolicyArgs>(args)...);
+        finish_load(key);
+        lock.unlock();
+
+        promise.set_value(value);
+        return value;
+      }
+      catch (...)
+      {
+        if (!lock.owns_lock())
+          lock.lock();
+        finish_load(key);
+        lock.unlock();
+
+        promise.set_exception(std::current_exception());
+        throw;
+      }
+    }
+
+    void erase(const key_type& key)
     {
       std::lock_guard<locking_policy> lock(lock_);
 
       // first expire elements if necessary
       expire();
 
-      return caching_policy::touch_key(key);
+      erase_internal(key);
     }
 
-    template<typename... CachingPolicyArgs>
-    void insert(const key_type& key, const cached_type& value, CachingPolicyArgs&&... args)
+    // changes the maximum size of a caching policy with a dynamic size and
+    // expires keys one after the other until the new maximum size is reached
+    void resize(typename caching_policy::size_type max_size)
     {
       std::lock_guard<locking_policy> lock(lock_);
 
       // first expire elements if necessary
       expire();
 
-      // insert the key into the caching policy and get any expired keys
-      const auto expired_keys = caching_policy::insert_key(key, std::forward<CachingPolicyArgs>(args)...);
+      caching_policy::set_max_size(max_size);
+      while (caching_policy::size() > max_size && caching_policy::evict_key(expired_keys_))
+      { }
 
       // remove the expired keys from the storage policy
-      expire_from_storage(expired_keys);
+      expire_from_storage();
+    }
 
-      // insert the item into the storage policy
-      storage_policy::insert_into_storage(key, value);
+    // changes the default maximum age of a caching policy with a dynamic
+    // default maximum age. keys which are already cached keep their maximum age.
+    void set_default_max_age(size_t max_age_ms)
+    {
+      std::lock_guard<locking_policy> lock(lock_);
+
+      caching_policy::set_default_max_age(max_age_ms);
     }
 
-    void erase(const key_type& key)
+    void clear()
     {
       std::lock_guard<locking_policy> lock(lock_);
+      storage_provider::clear_storage();
+      caching_policy::clear_keys();
+      weight_ = 0;
+    }
 
+  private:
+    template<typename... CachingPolicyArgs>
+    bool insert_internal(const key_type& key, const cached_type& value, CachingPolicyArgs&&... args)
+    {
       // first expire elements if necessary
       expire();
 
+      return store(key, value, std::forward<CachingPolicyArgs>(args)...);
+    }
+
+    template<typename... CachingPolicyArgs>
+    bool store(const key_type& key, const cached_type& value, CachingPolicyArgs&&... args)
+    {
+      const weight_type value_weight = weigh(key, value);
+      if (value_weight > max_weight_)
+      {
+        // don't keep serving the value the caller tried to replace
+        erase_internal(key);
+        return false;
+      }
+
+      // make room for the value before inserting it so that the caching policy
+      // can't pick it as the key to expire. the weight of a value which is
+      // replaced doesn't count.
+      while (weight_internal() > max_weight_ - value_weight &&
+             weight_internal() - stored_weight(key) > max_weight_ - value_weight &&
+             caching_policy::evict_key(expired_keys_))
+        expire_from_storage();
+
+      const weight_type replaced_weight = weighted ? stored_weight(key) : 0;
+
+      // a caching policy storing the values creates the entry of the key
+      // together with its value before the key is inserted
+      if (stored_in_caching_policy)
+        storage_provider::insert_into_storage(key, value);
+
+      // insert the key into the caching policy and get any expired keys
+      caching_policy::insert_key(expired_keys_, key, std::forward<CachingPolicyArgs>(args)...);
+
+      // remove the expired keys from the storage policy
+      expire_from_storage();
+
+      // insert the item into the storage policy
+      if (!stored_in_caching_policy)
+        storage_provider::insert_into_storage(key, value);
+
+      if (weighted)
+        weight_ = weight_ - replaced_weight + value_weight;
+
+      return true;
+    }
+
+    void erase_internal(const key_type& key)
+    {
       // erase the key from the caching policy
       if (!caching_policy::erase_key(key))
         return;
 
       // erase the item from the storage policy
-      storage_policy::erase_from_storage(key);
+      if (weighted)
+        weight_ -= weight_in_storage(key);
+      storage_provider::erase_from_storage(key);
     }
 
-    void clear()
+    void finish_load(const key_type& key)
     {
-      std::lock_guard<locking_policy> lock(lock_);
-      storage_policy::clear_storage();
-      caching_policy::clear_keys();
+      for (auto it = loads_.begin(); it != loads_.end(); ++it)
+      {
+        if (it->first == key)
+        {
+          loads_.erase(it);
+          return;
+        }
+      }
+    }
+
+    inline weight_type weigh(const key_type& key, const cached_type& value) const
+    {
+      return weighted ? weigher_(key, value) : 1;
+    }
+
+    inline weight_type weight_internal() const
+    {
+      return weighted ? weight_ : caching_policy::size();
+    }
+
+    // weight of the value currently cached for the given key
+    weight_type stored_weight(const key_type& key) const
+    {
+      if (!caching_policy::has_key(key))
+        return 0;
+
+      return weighted ? weight_in_storage(key) : 1;
     }
 
-  private:
     inline bool has_internal(const key_type& key) const
     {
       // TODO: what if it is present in the caching policy but not in the storage policy???
       return caching_policy::has_key(key);
     }
 
-    const cached_type& get_internal(const key_type& key) const
+    const cached_type* find_internal(const key_type& key) const
     {
       // first expire elements if necessary
       expire();
 
-      // check if the key is cached and if so touch it
-      if (!has_internal(key) || !caching_policy::touch_key(key))
-        throw std::out_of_range("element not present in the cache");
+      return lookup(key);
+    }
+
+    const cached_type* lookup(const key_type& key) const
+    {
+      // touching the key fails if it isn't cached
+      if (!caching_policy::touch_key(key))
+        return nullptr;
 
-      return storage_policy::get_from_storage(key);
+      return storage_provider::find_in_storage(key);
     }
 
     void expire() const
     {
+      // caching policies with shared reads never expire keys on their own
+      if (detail::shared_reads<caching_policy>::value)
+        return;
+
       // get all the expired keys from the caching policy
-      const auto expired_keys = caching_policy::expire_keys();
+      caching_policy::expire_keys(expired_keys_);
 
       // remove the expired keys from the storage policy
-      expire_from_storage(expired_keys);
+      expire_from_storage();
+    }
+
+    void expire_from_storage() const
+    {
+      for (const auto& key : expired_keys_)
+      {
+        if (weighted)
+          weight_ -= weight_in_storage(key);
+        storage_provider::erase_from_storage(key);
+      }
+
+      // keep the capacity for the next time keys expire
+      expired_keys_.clear();
     }
 
-    void expire_from_storage(const std::vector<key_type>& keys) const
+    // weight of the value in the storage policy no matter if the key is still
+    // known to the caching policy (e.g. because it has just been expired)
+    weight_type weight_in_storage(const key_type& key) const
     {
-      for (const auto& key : keys)
-        storage_policy::erase_from_storage(key);
+      const cached_type* value = storage_provider::find_in_storage(key);
+      return value != nullptr ? weigh(key, *value) : 0;
     }
 
+    // buffer collecting the keys expired by the caching policy
+    mutable std::vector<key_type> expired_keys_;
+    weigher weigher_;
+    mutable weight_type weight_;
+    weight_type max_weight_;
+    // results of the loads currently in flight. there are only ever as many
+    // as there are threads so a linear search is good enough.
+    std::vector<std::pair<key_type, std::shared_future<cached_type>>> loads_;
     mutable locking_policy lock_;
   };
 }
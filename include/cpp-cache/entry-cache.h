@@ -0,0 +1,32 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ */
+
+#ifndef CPP_CACHE_ENTRY_CACHE_H_
+#define CPP_CACHE_ENTRY_CACHE_H_
+
+#include "cache.h"
+#include "policy/entry.h"
+#include "policy/entry-lru.h"
+#include "policy/entry-ttl.h"
+#include "storage/entry.h"
+
+namespace cpp_cache
+{
+  template<class Key, class T, size_t MaxSize, class LockingPolicy = no_locking, class Weigher = unweighted>
+  using entry_lru_cache = cpp_cache::cache<Key, T,
+    policy::entry_lru<Key, MaxSize, policy::entry_table<Key, T, policy::entry_lru_hook>>,
+    storage::entry<Key, T>, LockingPolicy, Weigher>;
+
+  template<class Key, class T, size_t MaxAgeMs, class LockingPolicy = no_locking, class Weigher = unweighted>
+  using entry_ttl_cache = cpp_cache::cache<Key, T,
+    policy::entry_ttl<Key, MaxAgeMs, policy::entry_table<Key, T, policy::entry_ttl_hook>>,
+    storage::entry<Key, T>, LockingPolicy, Weigher>;
+
+  template<class Key, class T, size_t MaxSize, size_t MaxAgeMs, class LockingPolicy = no_locking, class Weigher = unweighted>
+  using entry_lru_ttl_cache = cpp_cache::cache<Key, T,
+    policy::entry_lru<Key, MaxSize, policy::entry_ttl<Key, MaxAgeMs, policy::entry_table<Key, T, policy::entry_lru_hook, policy::entry_ttl_hook>>>,
+    storage::entry<Key, T>, LockingPolicy, Weigher>;
+}
+
+#endif  // CPP_CACHE_ENTRY_CACHE_H_
@@ -2,8 +2,8 @@
  *  Copyright (C) Sascha Montellese
  */
 
-#ifndef CPP_CACHE_LRU_CACHE_H_
-#define CPP_CACHE_LRU_CACHE_H_
+#ifndef CPP_CACHE_LFU_CACHE_H_
+#define CPP_CACHE_LFU_CACHE_H_
 
 #include "cache.h"
 #include "policy/lfu.h"
@@ -11,8 +11,8 @@
 
 namespace cpp_cache
 {
-  template<class Key, class T, size_t MaxSize, class StoragePolicy = storage::map<Key, T>, class LockingPolicy = no_locking>
-  using lfu_cache = cpp_cache::cache<Key, T, policy::lfu<Key, MaxSize>, StoragePolicy, LockingPolicy>;
+  template<class Key, class T, size_t MaxSize, class StoragePolicy = storage::map<Key, T>, class LockingPolicy = no_locking, class Weigher = unweighted>
+  using lfu_cache = cpp_cache::cache<Key, T, policy::lfu<Key, MaxSize>, StoragePolicy, LockingPolicy, Weigher>;
 }
 
-#endif  // CPP_CACHE_LRU_CACHE_H_
\ No newline at end of file
+#endif  // CPP_CACHE_LFU_CACHE_H_
\ No newline at end of file
@@ -0,0 +1,18 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ */
+
+#ifndef CPP_CACHE_LRU_K_CACHE_H_
+#define CPP_CACHE_LRU_K_CACHE_H_
+
+#include "cache.h"
+#include "policy/lru-k.h"
+#include "storage/map.h"
+
+namespace cpp_cache
+{
+  template<class Key, class T, size_t MaxSize, class StoragePolicy = storage::map<Key, T>, class LockingPolicy = no_locking, class Weigher = unweighted>
+  using lru_k_cache = cpp_cache::cache<Key, T, policy::lru_k<Key, MaxSize>, StoragePolicy, LockingPolicy, Weigher>;
+}
+
+#endif  // CPP_CACHE_LRU_K_CACHE_H_
\ No newline at end of file
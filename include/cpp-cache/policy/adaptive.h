@@ -0,0 +1,349 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ */
+
+#ifndef CPP_CACHE_POLICY_ADAPTIVE_H_
+#define CPP_CACHE_POLICY_ADAPTIVE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "dynamic.h"
+#include "fifo.h"
+#include "lfu.h"
+#include "lru.h"
+#include "none.h"
+#include "sieve.h"
+
+namespace cpp_cache
+{
+namespace policy
+{
+  // list of the caching policies an adaptive policy chooses from. every policy
+  // has to take the key, the maximum size and the chained caching policy as
+  // its template parameters.
+  template<template<class, size_t, class> class... Policies>
+  struct adaptive_candidates
+  { };
+
+  // meta policy which evicts keys using the candidate caching policy with the
+  // best hit ratio. every candidate tracks all cached keys so that it can take
+  // over at any time. in addition every candidate simulates a cache of
+  // 1 / SampleRate of the maximum size for the keys whose hash falls into the
+  // same 1 / SampleRate of all hashes. after every Period uses of sampled keys
+  // the candidate with the most hits in its simulated cache becomes the
+  // active one. the hits are halved afterwards so that older uses count less.
+  template<class Key, size_t MaxSize, class Candidates = adaptive_candidates<lru, fifo, sieve, lfu>,
+           size_t SampleRate = 16, size_t Period = 1024, class ChainedCachingPolicy = none<Key, size_t>>
+  class adaptive : public ChainedCachingPolicy, private dynamic_value<MaxSize, ChainedCachingPolicy>
+  {
+  public:
+    using key_type = Key;
+    using size_type = size_t;
+
+    static_assert(SampleRate > 0, "the sample rate has to be positive");
+    static_assert(Period > 0, "the period has to be positive");
+
+    // touching a key updates all candidates and their simulated caches
+    static constexpr bool shared_reads = false;
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size != dynamic, int>::type = 0>
+    explicit adaptive(ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(MaxSize)
+      , candidates_()
+      , simulations_()
+      , hits_()
+      , samples_(0)
+      , active_(0)
+      , unused_keys_()
+    {
+      add_candidates(Candidates());
+    }
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size == dynamic, int>::type = 0>
+    explicit adaptive(size_type max_size, ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(max_size)
+      , candidates_()
+      , simulations_()
+      , hits_()
+      , samples_(0)
+      , active_(0)
+      , unused_keys_()
+    {
+      add_candidates(Candidates());
+    }
+
+    virtual ~adaptive()
+    {
+      clear_keys();
+    }
+
+    inline size_type max_size() const { return max_size_value::value(); }
+
+    // the index of the candidate currently used for eviction in the list of
+    // candidates
+    inline size_type active_candidate() const { return active_; }
+
+  protected:
+    inline virtual size_type size() const override { return candidates_[active_]->size(); }
+
+    inline virtual bool empty() const override { return candidates_[active_]->empty(); }
+
+    inline virtual bool has_key(const key_type& key) const override
+    {
+      return candidates_[active_]->has(key);
+    }
+
+    inline virtual bool touch_key(const key_type& key) const override
+    {
+      // pass the touch on to the chained policy
+      if (!ChainedCachingPolicy::touch_key(key))
+        return false;
+
+      // check if we have the key cached
+      if (!candidates_[active_]->has(key))
+        return false;
+
+      for (const auto& candidate : candidates_)
+        candidate->touch(key);
+
+      simulate(key);
+
+      return true;
+    }
+
+    template<typename... Args>
+    inline void insert_key(std::vector<key_type>& expired_keys, const key_type& key, Args&&... args)
+    {
+      // insert the key into the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::insert_key(expired_keys, key, std::forward<Args>(args)...);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      simulate(key);
+
+      // check if we need to expire a key as well
+      if (!candidates_[active_]->has(key) && is_full())
+        evict_key(expired_keys);
+
+      // the candidates are never full so they don't evict any keys on their own
+      for (const auto& candidate : candidates_)
+        candidate->insert(unused_keys_, key);
+      unused_keys_.clear();
+    }
+
+    inline virtual bool erase_key(const key_type& key) override
+    {
+      if (!candidates_[active_]->has(key))
+        return false;
+
+      ChainedCachingPolicy::erase_key(key);
+
+      for (const auto& candidate : candidates_)
+        candidate->erase(key);
+
+      return true;
+    }
+
+    inline virtual void clear_keys() override
+    {
+      ChainedCachingPolicy::clear_keys();
+
+      for (const auto& candidate : candidates_)
+        candidate->clear();
+      for (const auto& simulation : simulations_)
+        simulation->clear();
+
+      std::fill(hits_.begin(), hits_.end(), 0);
+      samples_ = 0;
+      active_ = 0;
+    }
+
+    virtual void expire_keys(std::vector<key_type>& expired_keys) const override
+    {
+      // expire on the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::expire_keys(expired_keys);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      // nothing else to do because we expire on insert
+    }
+
+    // changes the maximum size of a policy with a dynamic size. the keys
+    // exceeding the new maximum size have to be removed using evict_key()
+    inline void set_max_size(size_type max_size)
+    {
+      static_assert(MaxSize == dynamic, "only a caching policy with a dynamic size can be resized");
+
+      max_size_value::set_value(max_size);
+
+      for (const auto& candidate : candidates_)
+        candidate->resize(max_size);
+      for (const auto& simulation : simulations_)
+      {
+        simulation->resize(simulated_size());
+        while (simulation->size() > simulated_size() && simulation->evict(unused_keys_))
+          unused_keys_.clear();
+      }
+    }
+
+    // expires the key chosen by the active candidate
+    bool evict_key(std::vector<key_type>& expired_keys)
+    {
+      if (!candidates_[active_]->evict(expired_keys))
+        return false;
+
+      const key_type key = expired_keys.back();
+      ChainedCachingPolicy::erase_key(key);
+
+      for (size_type index = 0; index < candidates_.size(); ++index)
+      {
+        if (index != active_)
+          candidates_[index]->erase(key);
+      }
+
+      return true;
+    }
+
+  private:
+    using max_size_value = policy::dynamic_value<MaxSize, ChainedCachingPolicy>;
+
+    // common interface of the candidates hiding their type
+    class candidate_base
+    {
+    public:
+      virtual ~candidate_base() = default;
+
+      virtual size_type size() const = 0;
+      virtual bool empty() const = 0;
+      virtual bool has(const key_type& key) const = 0;
+      virtual bool touch(const key_type& key) const = 0;
+      virtual void insert(std::vector<key_type>& expired_keys, const key_type& key) = 0;
+      virtual bool erase(const key_type& key) = 0;
+      virtual void clear() = 0;
+      virtual bool evict(std::vector<key_type>& expired_keys) = 0;
+      virtual void resize(size_type max_size) = 0;
+    };
+
+    template<class CachingPolicy>
+    class candidate_policy : public candidate_base, public CachingPolicy
+    {
+    public:
+      explicit candidate_policy(size_type max_size)
+        : CachingPolicy(max_size)
+      { }
+
+      virtual size_type size() const override { return CachingPolicy::size(); }
+      virtual bool empty() const override { return CachingPolicy::empty(); }
+      virtual bool has(const key_type& key) const override { return CachingPolicy::has_key(key); }
+      virtual bool touch(const key_type& key) const override { return CachingPolicy::touch_key(key); }
+      virtual void insert(std::vector<key_type>& expired_keys, const key_type& key) override { CachingPolicy::insert_key(expired_keys, key); }
+      virtual bool erase(const key_type& key) override { return CachingPolicy::erase_key(key); }
+      virtual void clear() override { CachingPolicy::clear_keys(); }
+      virtual bool evict(std::vector<key_type>& expired_keys) override { return CachingPolicy::evict_key(expired_keys); }
+      virtual void resize(size_type max_size) override { CachingPolicy::set_max_size(max_size); }
+    };
+
+    using candidate_list = std::vector<std::unique_ptr<candidate_base>>;
+
+    template<template<class, size_t, class> class... Policies>
+    void add_candidates(adaptive_candidates<Policies...>)
+    {
+      static_assert(sizeof...(Policies) > 0, "at least one candidate is needed");
+
+      using expand = int[];
+      (void)expand { 0, (add_candidate<Policies<key_type, dynamic, none<key_type, size_type>>>(), 0)... };
+
+      hits_.resize(candidates_.size(), 0);
+    }
+
+    template<class CachingPolicy>
+    void add_candidate()
+    {
+      candidates_.emplace_back(new candidate_policy<CachingPolicy>(max_size()));
+      simulations_.emplace_back(new candidate_policy<CachingPolicy>(simulated_size()));
+    }
+
+    inline bool is_full() const
+    {
+      return candidates_[active_]->size() >= max_size();
+    }
+
+    inline size_type simulated_size() const
+    {
+      const size_type size = max_size() / SampleRate;
+      return size > 0 ? size : 1;
+    }
+
+    inline static bool sampled(const key_type& key)
+    {
+      // mix the hash because many hash functions (e.g. for integers) don't
+      const uint64_t hash = static_cast<uint64_t>(std::hash<key_type>()(key)) * UINT64_C(0x9E3779B97F4A7C15);
+      return (hash >> 32) % SampleRate == 0;
+    }
+
+    // uses the key in the simulated cache of every candidate and switches to
+    // the best candidate at the end of a period
+    void simulate(const key_type& key) const
+    {
+      if (!sampled(key))
+        return;
+
+      for (size_type index = 0; index < simulations_.size(); ++index)
+      {
+        if (simulations_[index]->touch(key))
+          ++hits_[index];
+        else
+        {
+          simulations_[index]->insert(unused_keys_, key);
+          unused_keys_.clear();
+        }
+      }
+
+      if (++samples_ < Period)
+        return;
+
+      // only switch to a candidate which is actually better
+      for (size_type index = 0; index < hits_.size(); ++index)
+      {
+        if (hits_[index] > hits_[active_])
+          active_ = index;
+      }
+
+      for (auto& hits : hits_)
+        hits /= 2;
+      samples_ = 0;
+    }
+
+    void erase_keys(const std::vector<key_type>& keys, size_type first_key) const
+    {
+      for (size_type index = first_key; index < keys.size(); ++index)
+      {
+        for (const auto& candidate : candidates_)
+          candidate->erase(keys[index]);
+      }
+    }
+
+    candidate_list candidates_;
+    candidate_list simulations_;
+    mutable std::vector<size_type> hits_;
+    mutable size_type samples_;
+    mutable size_type active_;
+    mutable std::vector<key_type> unused_keys_;
+  };
+}
+}
+
+#endif  // CPP_CACHE_POLICY_ADAPTIVE_H_
@@ -0,0 +1,327 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ */
+
+#ifndef CPP_CACHE_POLICY_ARC_H_
+#define CPP_CACHE_POLICY_ARC_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <list>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "dynamic.h"
+#include "ghost.h"
+#include "none.h"
+
+namespace cpp_cache
+{
+namespace policy
+{
+  // adaptive replacement cache. keys which have been used once are kept in
+  // the recency list T1 and keys which have been used at least twice in the
+  // frequency list T2. keys evicted from T1 and T2 are remembered in the
+  // ghost lists B1 and B2. a miss on a key remembered in B1 (B2) shows that
+  // T1 (T2) is too small and moves the target size of T1 accordingly.
+  template<class Key, size_t MaxSize, class ChainedCachingPolicy = none<Key, size_t>>
+  class arc : public ChainedCachingPolicy, private dynamic_value<MaxSize, ChainedCachingPolicy>
+  {
+  public:
+    using key_type = Key;
+    using size_type = size_t;
+
+    // touching a key moves it to the front of T2
+    static constexpr bool shared_reads = false;
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size != dynamic, int>::type = 0>
+    explicit arc(ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(MaxSize)
+      , recent_()
+      , frequent_()
+      , map_()
+      , recent_ghosts_()
+      , frequent_ghosts_()
+      , target_recent_size_(0)
+    {
+      map_.reserve(MaxSize);
+    }
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size == dynamic, int>::type = 0>
+    explicit arc(size_type max_size, ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(max_size)
+      , recent_()
+      , frequent_()
+      , map_()
+      , recent_ghosts_()
+      , frequent_ghosts_()
+      , target_recent_size_(0)
+    {
+      map_.reserve(max_size);
+    }
+
+    virtual ~arc()
+    {
+      clear_keys();
+    }
+
+    inline size_type max_size() const { return max_size_value::value(); }
+
+    // the number of keys T1 should hold as adapted to the keys seen so far
+    inline size_type target_recent_size() const { return target_recent_size_; }
+
+  protected:
+    inline virtual size_type size() const override { return map_.size(); }
+
+    inline virtual bool empty() const override { return map_.empty(); }
+
+    inline virtual bool has_key(const key_type& key) const override
+    {
+      return map_.find(key) != map_.cend();
+    }
+
+    inline virtual bool touch_key(const key_type& key) const override
+    {
+      // pass the touch on to the chained policy
+      if (!ChainedCachingPolicy::touch_key(key))
+        return false;
+
+      // check if we have the key cached
+      auto it = map_.find(key);
+      if (it == map_.cend())
+        return false;
+
+      move_key_to_frequent(it->second);
+
+      return true;
+    }
+
+    template<typename... Args>
+    inline void insert_key(std::vector<key_type>& expired_keys, const key_type& key, Args&&... args)
+    {
+      // insert the key into the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::insert_key(expired_keys, key, std::forward<Args>(args)...);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      // if we already have the key it counts as a touch
+      auto it = map_.find(key);
+      if (it != map_.cend())
+      {
+        move_key_to_frequent(it->second);
+        return;
+      }
+
+      // T1 was too small to keep the key
+      if (recent_ghosts_.erase(key))
+      {
+        const size_type delta = std::max<size_type>(frequent_ghosts_.size() / (recent_ghosts_.size() + 1), 1);
+        target_recent_size_ = std::min(target_recent_size_ + delta, max_size());
+
+        if (is_full())
+          replace(expired_keys, false);
+
+        insert_frequent(key);
+        return;
+      }
+
+      // T2 was too small to keep the key
+      if (frequent_ghosts_.erase(key))
+      {
+        const size_type delta = std::max<size_type>(recent_ghosts_.size() / (frequent_ghosts_.size() + 1), 1);
+        target_recent_size_ = target_recent_size_ > delta ? target_recent_size_ - delta : 0;
+
+        if (is_full())
+          replace(expired_keys, true);
+
+        insert_frequent(key);
+        return;
+      }
+
+      // a completely new key
+      if (recent_.size() + recent_ghosts_.size() >= max_size())
+      {
+        if (recent_.size() < max_size())
+        {
+          recent_ghosts_.pop();
+          if (is_full())
+            replace(expired_keys, false);
+        }
+        // T1 takes up the whole cache so its oldest key isn't worth remembering
+        else
+          evict_entry(map_.find(recent_.back()), expired_keys);
+      }
+      else if (is_full())
+      {
+        if (map_.size() + recent_ghosts_.size() + frequent_ghosts_.size() >= 2 * max_size())
+          frequent_ghosts_.pop();
+
+        replace(expired_keys, false);
+      }
+
+      recent_.push_front(key);
+      map_[key] = entry { recent_.begin(), false };
+    }
+
+    inline virtual bool erase_key(const key_type& key) override
+    {
+      auto it = map_.find(key);
+      if (it == map_.cend())
+        return false;
+
+      ChainedCachingPolicy::erase_key(key);
+
+      erase_entry(it);
+
+      return true;
+    }
+
+    inline virtual void clear_keys() override
+    {
+      ChainedCachingPolicy::clear_keys();
+
+      map_.clear();
+      recent_.clear();
+      frequent_.clear();
+      recent_ghosts_.clear();
+      frequent_ghosts_.clear();
+      target_recent_size_ = 0;
+    }
+
+    virtual void expire_keys(std::vector<key_type>& expired_keys) const override
+    {
+      // expire on the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::expire_keys(expired_keys);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      // nothing else to do because we expire on insert
+    }
+
+    // changes the maximum size of a policy with a dynamic size. the keys
+    // exceeding the new maximum size have to be removed using evict_key()
+    inline void set_max_size(size_type max_size)
+    {
+      static_assert(MaxSize == dynamic, "only a caching policy with a dynamic size can be resized");
+
+      max_size_value::set_value(max_size);
+      target_recent_size_ = std::min(target_recent_size_, max_size);
+    }
+
+    // expires the oldest key of T1 or T2 depending on the target size of T1
+    bool evict_key(std::vector<key_type>& expired_keys)
+    {
+      if (map_.empty())
+        return false;
+
+      replace(expired_keys, false);
+
+      return true;
+    }
+
+  private:
+    using max_size_value = policy::dynamic_value<MaxSize, ChainedCachingPolicy>;
+
+    using list = std::list<key_type>;
+    using list_iterator = typename list::iterator;
+
+    struct entry
+    {
+      list_iterator position_;
+      bool frequent_;
+    };
+
+    using map = std::unordered_map<key_type, entry>;
+    using map_iterator = typename map::iterator;
+
+    inline bool is_full() const
+    {
+      return map_.size() >= max_size();
+    }
+
+    inline void move_key_to_frequent(entry& key_entry) const
+    {
+      frequent_.splice(frequent_.begin(), key_entry.frequent_ ? frequent_ : recent_, key_entry.position_);
+      key_entry.frequent_ = true;
+    }
+
+    inline void insert_frequent(const key_type& key)
+    {
+      frequent_.push_front(key);
+      map_[key] = entry { frequent_.begin(), true };
+    }
+
+    // evicts the oldest key of T1 if it exceeds its target size (or the key is
+    // remembered in B2) and the oldest key of T2 otherwise and remembers it
+    void replace(std::vector<key_type>& expired_keys, bool in_frequent_ghosts)
+    {
+      const bool from_recent = !recent_.empty() &&
+        (frequent_.empty() || recent_.size() > target_recent_size_ || (in_frequent_ghosts && recent_.size() == target_recent_size_));
+
+      const key_type key = from_recent ? recent_.back() : frequent_.back();
+      evict_entry(map_.find(key), expired_keys);
+
+      if (from_recent)
+        recent_ghosts_.push(key);
+      else
+        frequent_ghosts_.push(key);
+
+      // keep the ghost lists within twice the maximum size
+      while (!recent_ghosts_.empty() && recent_.size() + recent_ghosts_.size() > max_size())
+        recent_ghosts_.pop();
+      while (!frequent_ghosts_.empty() && map_.size() + recent_ghosts_.size() + frequent_ghosts_.size() > 2 * max_size())
+        frequent_ghosts_.pop();
+    }
+
+    inline void erase_entry(map_iterator it) const
+    {
+      if (it->second.frequent_)
+        frequent_.erase(it->second.position_);
+      else
+        recent_.erase(it->second.position_);
+
+      map_.erase(it);
+    }
+
+    inline void evict_entry(map_iterator it, std::vector<key_type>& expired_keys)
+    {
+      const key_type key = it->first;
+      ChainedCachingPolicy::erase_key(key);
+
+      erase_entry(it);
+
+      expired_keys.push_back(key);
+    }
+
+    void erase_keys(const std::vector<key_type>& keys, size_type first_key) const
+    {
+      for (size_type index = first_key; index < keys.size(); ++index)
+      {
+        const key_type& key = keys[index];
+        auto it = map_.find(key);
+        if (it == map_.end())
+          continue;
+
+        erase_entry(it);
+      }
+    }
+
+    mutable list recent_;
+    mutable list frequent_;
+    mutable map map_;
+    ghost_list<key_type> recent_ghosts_;
+    ghost_list<key_type> frequent_ghosts_;
+    size_type target_recent_size_;
+  };
+}
+}
+
+#endif  // CPP_CACHE_POLICY_ARC_H_
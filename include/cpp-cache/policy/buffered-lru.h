@@ -0,0 +1,341 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ */
+
+#ifndef CPP_CACHE_POLICY_BUFFERED_LRU_H_
+#define CPP_CACHE_POLICY_BUFFERED_LRU_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "dynamic.h"
+#include "none.h"
+
+namespace cpp_cache
+{
+namespace policy
+{
+  // least recently used policy which doesn't reorder its list on every touch.
+  // instead touches are recorded in lossy read buffers (one per stripe of
+  // threads) and applied in batches by whichever thread manages to get the
+  // drain lock once a buffer is full. touching a key therefore only needs a
+  // hash lookup and multiple threads can touch keys at the same time (e.g.
+  // using cpp_cache::shared_locking). the recorded touches are always applied
+  // before a key is inserted, erased or evicted.
+  template<class Key, size_t MaxSize, class ChainedCachingPolicy = none<Key, size_t>>
+  class buffered_lru : public ChainedCachingPolicy, private dynamic_value<MaxSize, ChainedCachingPolicy>
+  {
+  public:
+    using key_type = Key;
+    using size_type = size_t;
+
+    // touching a key only records it in a thread-safe read buffer
+    static constexpr bool shared_reads = cpp_cache::detail::shared_reads<ChainedCachingPolicy>::value;
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size != dynamic, int>::type = 0>
+    explicit buffered_lru(ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(MaxSize)
+      , list_()
+      , map_()
+      , read_buffers_()
+      , drain_lock_()
+    {
+      map_.reserve(MaxSize);
+    }
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size == dynamic, int>::type = 0>
+    explicit buffered_lru(size_type max_size, ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(max_size)
+      , list_()
+      , map_()
+      , read_buffers_()
+      , drain_lock_()
+    {
+      map_.reserve(max_size);
+    }
+
+    virtual ~buffered_lru()
+    {
+      clear_keys();
+    }
+
+    inline size_type max_size() const { return max_size_value::value(); }
+
+  protected:
+    inline virtual size_type size() const override { return map_.size(); }
+
+    inline virtual bool empty() const override { return map_.empty(); }
+
+    inline virtual bool has_key(const key_type& key) const override
+    {
+      return map_.find(key) != map_.cend();
+    }
+
+    inline virtual bool touch_key(const key_type& key) const override
+    {
+      // pass the touch on to the chained policy
+      if (!ChainedCachingPolicy::touch_key(key))
+        return false;
+
+      // check if we have the key cached
+      auto it = map_.find(key);
+      if (it == map_.cend())
+        return false;
+
+      // record the touch instead of moving the key to the front right away
+      if (read_buffers_[read_buffer_index()].record(&it->second))
+        try_drain();
+
+      return true;
+    }
+
+    template<typename... Args>
+    inline void insert_key(std::vector<key_type>& expired_keys, const key_type& key, Args&&... args)
+    {
+      drain();
+
+      // insert the key into the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::insert_key(expired_keys, key, std::forward<Args>(args)...);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      // if we already have the key it only has to be moved to the front
+      auto it = map_.find(key);
+      if (it != map_.cend())
+      {
+        move_key_to_front(it->second);
+        return;
+      }
+
+      // check if we need to expire a key as well
+      if (is_full())
+        evict_key(expired_keys);
+
+      // add the key to the front of the list (most recently used)
+      list_.push_front(key);
+      map_[key] = list_.begin();
+    }
+
+    inline virtual bool erase_key(const key_type& key) override
+    {
+      drain();
+
+      auto it = map_.find(key);
+      if (it == map_.cend())
+        return false;
+
+      ChainedCachingPolicy::erase_key(key);
+
+      list_.erase(it->second);
+      map_.erase(it);
+
+      return true;
+    }
+
+    inline virtual void clear_keys() override
+    {
+      ChainedCachingPolicy::clear_keys();
+
+      // the recorded touches would point at erased keys
+      for (auto& buffer : read_buffers_)
+        buffer.clear();
+
+      map_.clear();
+      list_.clear();
+    }
+
+    virtual void expire_keys(std::vector<key_type>& expired_keys) const override
+    {
+      // expire on the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::expire_keys(expired_keys);
+
+      // remove all the keys that were expired in the chained policy
+      if (first_expired_key < expired_keys.size())
+      {
+        drain();
+        erase_keys(expired_keys, first_expired_key);
+      }
+
+      // nothing else to do because we expire on insert
+    }
+
+    // changes the maximum size of a policy with a dynamic size. the keys
+    // exceeding the new maximum size have to be removed using evict_key()
+    inline void set_max_size(size_type max_size)
+    {
+      static_assert(MaxSize == dynamic, "only a caching policy with a dynamic size can be resized");
+
+      max_size_value::set_value(max_size);
+    }
+
+    // expires the least recently used key
+    bool evict_key(std::vector<key_type>& expired_keys)
+    {
+      drain();
+
+      if (list_.empty())
+        return false;
+
+      const key_type last_key = list_.back();
+      ChainedCachingPolicy::erase_key(last_key);
+
+      map_.erase(last_key);
+      list_.pop_back();
+
+      expired_keys.push_back(last_key);
+
+      return true;
+    }
+
+  private:
+    using max_size_value = policy::dynamic_value<MaxSize, ChainedCachingPolicy>;
+
+    using list = std::list<key_type>;
+    using list_iterator = typename list::iterator;
+    using map = std::unordered_map<key_type, list_iterator>;
+
+    static constexpr size_t read_buffer_count = 16;
+    static constexpr size_t read_buffer_size = 32;
+    static constexpr size_t read_buffer_mask = read_buffer_size - 1;
+
+    // ring buffer of the positions of touched keys. recording a touch never
+    // blocks but drops the touch if the buffer is full or another thread
+    // claimed the same slot at the same time. only one thread at a time may
+    // drain the buffer.
+    class read_buffer
+    {
+    public:
+      read_buffer()
+        : head_(0)
+        , tail_(0)
+        , slots_()
+      {
+        for (auto& slot : slots_)
+          slot.store(nullptr, std::memory_order_relaxed);
+      }
+
+      // returns true if the buffer is full and should be drained
+      bool record(const list_iterator* position)
+      {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t head = head_.load(std::memory_order_acquire);
+        if (tail - head >= read_buffer_size)
+          return true;
+
+        size_t expected = tail;
+        if (!tail_.compare_exchange_strong(expected, tail + 1, std::memory_order_acq_rel))
+          return false;
+
+        slots_[tail & read_buffer_mask].store(position, std::memory_order_release);
+
+        return tail + 1 - head >= read_buffer_size;
+      }
+
+      template<class Function>
+      void drain(Function&& function)
+      {
+        size_t head = head_.load(std::memory_order_relaxed);
+        const size_t tail = tail_.load(std::memory_order_acquire);
+
+        for (; head != tail; ++head)
+        {
+          // stop at a slot which has been claimed but not written yet
+          const list_iterator* position = slots_[head & read_buffer_mask].exchange(nullptr, std::memory_order_acquire);
+          if (position == nullptr)
+            break;
+
+          function(*position);
+        }
+
+        head_.store(head, std::memory_order_release);
+      }
+
+      void clear()
+      {
+        for (auto& slot : slots_)
+          slot.store(nullptr, std::memory_order_relaxed);
+
+        head_.store(tail_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      }
+
+    private:
+      std::atomic<size_t> head_;
+      std::atomic<size_t> tail_;
+      std::array<std::atomic<const list_iterator*>, read_buffer_size> slots_;
+    };
+
+    inline bool is_full() const
+    {
+      return map_.size() >= max_size();
+    }
+
+    inline void move_key_to_front(list_iterator list_it) const
+    {
+      list_.splice(list_.begin(), list_, list_it);
+    }
+
+    // threads are spread over the read buffers by their id
+    inline static size_t read_buffer_index()
+    {
+      return std::hash<std::thread::id>()(std::this_thread::get_id()) % read_buffer_count;
+    }
+
+    // applies the recorded touches unless another thread is already doing it.
+    // reordering the list is safe while other threads are touching keys
+    // because touching only looks at the map.
+    void try_drain() const
+    {
+      std::unique_lock<std::mutex> lock(drain_lock_, std::try_to_lock);
+      if (lock.owns_lock())
+        drain_internal();
+    }
+
+    void drain() const
+    {
+      std::lock_guard<std::mutex> lock(drain_lock_);
+      drain_internal();
+    }
+
+    void drain_internal() const
+    {
+      for (auto& buffer : read_buffers_)
+        buffer.drain([this](list_iterator list_it) { move_key_to_front(list_it); });
+    }
+
+    void erase_keys(const std::vector<key_type>& keys, size_type first_key) const
+    {
+      for (size_type index = first_key; index < keys.size(); ++index)
+      {
+        const key_type& key = keys[index];
+        auto it = map_.find(key);
+        if (it == map_.cend())
+          continue;
+
+        list_.erase(it->second);
+        map_.erase(it);
+      }
+    }
+
+    mutable list list_;
+    mutable map map_;
+    mutable std::array<read_buffer, read_buffer_count> read_buffers_;
+    mutable std::mutex drain_lock_;
+  };
+}
+}
+
+#endif  // CPP_CACHE_POLICY_BUFFERED_LRU_H_
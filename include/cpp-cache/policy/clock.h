@@ -0,0 +1,322 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ */
+
+#ifndef CPP_CACHE_POLICY_CLOCK_H_
+#define CPP_CACHE_POLICY_CLOCK_H_
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "dynamic.h"
+#include "none.h"
+
+namespace cpp_cache
+{
+namespace policy
+{
+  // approximation of a least recently used policy keeping the keys in a
+  // circular array. touching a key only sets its reference bit. on eviction a
+  // hand sweeps over the array clearing reference bits until it finds a key
+  // which hasn't been referenced since the last sweep.
+  template<class Key, size_t MaxSize, class ChainedCachingPolicy = none<Key, size_t>>
+  class clock : public ChainedCachingPolicy, private dynamic_value<MaxSize, ChainedCachingPolicy>
+  {
+  public:
+    using key_type = Key;
+    using size_type = size_t;
+
+    // touching a key only sets an atomic reference bit
+    static constexpr bool shared_reads = cpp_cache::detail::shared_reads<ChainedCachingPolicy>::value;
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size != dynamic, int>::type = 0>
+    explicit clock(ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(MaxSize)
+      , slots_()
+      , free_slots_()
+      , map_()
+      , hand_(0)
+    {
+      slots_.reserve(MaxSize);
+      map_.reserve(MaxSize);
+    }
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size == dynamic, int>::type = 0>
+    explicit clock(size_type max_size, ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(max_size)
+      , slots_()
+      , free_slots_()
+      , map_()
+      , hand_(0)
+    {
+      slots_.reserve(max_size);
+      map_.reserve(max_size);
+    }
+
+    virtual ~clock()
+    {
+      clear_keys();
+    }
+
+    inline size_type max_size() const { return max_size_value::value(); }
+
+  protected:
+    inline virtual size_type size() const override { return map_.size(); }
+
+    inline virtual bool empty() const override { return map_.empty(); }
+
+    inline virtual bool has_key(const key_type& key) const override
+    {
+      return map_.find(key) != map_.cend();
+    }
+
+    inline virtual bool touch_key(const key_type& key) const override
+    {
+      // pass the touch on to the chained policy
+      if (!ChainedCachingPolicy::touch_key(key))
+        return false;
+
+      // check if we have the key cached
+      auto it = map_.find(key);
+      if (it == map_.cend())
+        return false;
+
+      slots_[it->second].reference();
+
+      return true;
+    }
+
+    template<typename... Args>
+    inline void insert_key(std::vector<key_type>& expired_keys, const key_type& key, Args&&... args)
+    {
+      // insert the key into the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::insert_key(expired_keys, key, std::forward<Args>(args)...);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      // if we already have the key it only has to be referenced
+      auto it = map_.find(key);
+      if (it != map_.cend())
+      {
+        slots_[it->second].reference();
+        return;
+      }
+
+      // check if we need to expire a key as well
+      if (is_full())
+        evict_key(expired_keys);
+
+      // reuse the slot of an evicted or erased key if possible
+      size_type index;
+      if (free_slots_.empty())
+      {
+        index = slots_.size();
+        slots_.emplace_back();
+      }
+      else
+      {
+        index = free_slots_.back();
+        free_slots_.pop_back();
+      }
+
+      slots_[index].use(key);
+      map_[key] = index;
+    }
+
+    inline virtual bool erase_key(const key_type& key) override
+    {
+      auto it = map_.find(key);
+      if (it == map_.cend())
+        return false;
+
+      ChainedCachingPolicy::erase_key(key);
+
+      free_slot(it->second);
+      map_.erase(it);
+
+      return true;
+    }
+
+    inline virtual void clear_keys() override
+    {
+      ChainedCachingPolicy::clear_keys();
+
+      map_.clear();
+      slots_.clear();
+      free_slots_.clear();
+      hand_ = 0;
+    }
+
+    virtual void expire_keys(std::vector<key_type>& expired_keys) const override
+    {
+      // expire on the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::expire_keys(expired_keys);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      // nothing else to do because we expire on insert
+    }
+
+    // changes the maximum size of a policy with a dynamic size. the keys
+    // exceeding the new maximum size have to be removed using evict_key()
+    inline void set_max_size(size_type max_size)
+    {
+      static_assert(MaxSize == dynamic, "only a caching policy with a dynamic size can be resized");
+
+      max_size_value::set_value(max_size);
+    }
+
+    // expires the first key under the hand which hasn't been referenced since
+    // the hand last passed it
+    bool evict_key(std::vector<key_type>& expired_keys)
+    {
+      if (map_.empty())
+        return false;
+
+      // every key gets a second chance so the hand needs at most two rounds
+      while (true)
+      {
+        if (hand_ >= slots_.size())
+          hand_ = 0;
+
+        slot& current = slots_[hand_++];
+        if (!current.used_ || current.clear_reference())
+          continue;
+
+        const key_type key = current.key_;
+        ChainedCachingPolicy::erase_key(key);
+
+        free_slot(hand_ - 1);
+        map_.erase(key);
+
+        expired_keys.push_back(key);
+
+        return true;
+      }
+    }
+
+  private:
+    using max_size_value = policy::dynamic_value<MaxSize, ChainedCachingPolicy>;
+
+    // the key is only constructed while the slot is used so that keys don't
+    // have to be default constructible and free slots don't keep evicted
+    // keys alive
+    struct slot
+    {
+      slot()
+        : referenced_(false)
+        , used_(false)
+      { }
+
+      // the reference bit is only ever read and written concurrently while
+      // the slots aren't moved so copying doesn't need to be atomic
+      slot(const slot& other)
+        : referenced_(other.referenced_.load(std::memory_order_relaxed))
+        , used_(false)
+      {
+        if (other.used_)
+          use(other.key_);
+      }
+
+      slot& operator=(const slot& other)
+      {
+        if (this != &other)
+        {
+          release();
+          if (other.used_)
+            use(other.key_);
+        }
+        referenced_.store(other.referenced_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+        return *this;
+      }
+
+      ~slot()
+      {
+        release();
+      }
+
+      inline void use(const key_type& key)
+      {
+        new (&key_) key_type(key);
+        used_ = true;
+      }
+
+      inline void release()
+      {
+        if (!used_)
+          return;
+
+        key_.~key_type();
+        used_ = false;
+      }
+
+      inline void reference()
+      {
+        // avoid writing to the cache line of a key which is already referenced
+        if (!referenced_.load(std::memory_order_relaxed))
+          referenced_.store(true, std::memory_order_relaxed);
+      }
+
+      // returns whether the key had been referenced
+      inline bool clear_reference()
+      {
+        return referenced_.exchange(false, std::memory_order_relaxed);
+      }
+
+      union
+      {
+        key_type key_;
+      };
+      std::atomic<bool> referenced_;
+      bool used_;
+    };
+
+    using map = std::unordered_map<key_type, size_type>;
+
+    inline bool is_full() const
+    {
+      return map_.size() >= max_size();
+    }
+
+    inline void free_slot(size_type index) const
+    {
+      slots_[index].release();
+      slots_[index].clear_reference();
+      free_slots_.push_back(index);
+    }
+
+    void erase_keys(const std::vector<key_type>& keys, size_type first_key) const
+    {
+      for (size_type index = first_key; index < keys.size(); ++index)
+      {
+        const key_type& key = keys[index];
+        auto it = map_.find(key);
+        if (it == map_.cend())
+          continue;
+
+        free_slot(it->second);
+        map_.erase(it);
+      }
+    }
+
+    mutable std::vector<slot> slots_;
+    mutable std::vector<size_type> free_slots_;
+    mutable map map_;
+    size_type hand_;
+  };
+}
+}
+
+#endif  // CPP_CACHE_POLICY_CLOCK_H_
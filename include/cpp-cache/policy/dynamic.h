@@ -0,0 +1,50 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ */
+
+#ifndef CPP_CACHE_POLICY_DYNAMIC_H_
+#define CPP_CACHE_POLICY_DYNAMIC_H_
+
+#include <cstddef>
+
+namespace cpp_cache
+{
+namespace policy
+{
+  // passed instead of a compile-time maximum size (or maximum age) to a
+  // caching policy which then takes the value as its first constructor
+  // argument and allows changing it at runtime
+  constexpr size_t dynamic = 0;
+
+  // base of a caching policy holding its maximum size (or maximum age). only
+  // a dynamic value is stored whereas a compile-time value is returned as is
+  // and the empty base takes up no space. the tag keeps the holders of
+  // chained caching policies apart.
+  template<size_t Value, class Tag>
+  class dynamic_value
+  {
+  protected:
+    explicit dynamic_value(size_t) { }
+
+    inline constexpr size_t value() const { return Value; }
+  };
+
+  template<class Tag>
+  class dynamic_value<dynamic, Tag>
+  {
+  protected:
+    explicit dynamic_value(size_t value)
+      : value_(value)
+    { }
+
+    inline size_t value() const { return value_; }
+
+    inline void set_value(size_t value) { value_ = value; }
+
+  private:
+    size_t value_;
+  };
+}
+}
+
+#endif  // CPP_CACHE_POLICY_DYNAMIC_H_
@@ -0,0 +1,244 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ */
+
+#ifndef CPP_CACHE_POLICY_ENTRY_LRU_H_
+#define CPP_CACHE_POLICY_ENTRY_LRU_H_
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "dynamic.h"
+#include "entry.h"
+
+namespace cpp_cache
+{
+namespace policy
+{
+  // links of an entry in the list of an entry_lru policy
+  struct entry_lru_hook
+  {
+    entry_lru_hook()
+      : prev_(nullptr)
+      , next_(nullptr)
+    { }
+
+    entry_lru_hook* prev_;
+    entry_lru_hook* next_;
+  };
+
+  // least recently used policy keeping its list links in the entries of the
+  // chained entry_table instead of a separate list and map
+  template<class Key, size_t MaxSize, class ChainedCachingPolicy>
+  class entry_lru : public ChainedCachingPolicy, private dynamic_value<MaxSize, ChainedCachingPolicy>
+  {
+  public:
+    using key_type = Key;
+    using size_type = size_t;
+    using entry_type = typename ChainedCachingPolicy::entry_type;
+
+    // touching a key moves it to the front of the list
+    static constexpr bool shared_reads = false;
+
+    static_assert(std::is_base_of<entry_lru_hook, entry_type>::value, "entry_lru requires an entry_table with an entry_lru_hook");
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size != dynamic, int>::type = 0>
+    explicit entry_lru(ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(MaxSize)
+      , head_()
+      , size_(0)
+    {
+      head_.prev_ = &head_;
+      head_.next_ = &head_;
+    }
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size == dynamic, int>::type = 0>
+    explicit entry_lru(size_type max_size, ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(max_size)
+      , head_()
+      , size_(0)
+    {
+      head_.prev_ = &head_;
+      head_.next_ = &head_;
+    }
+
+    entry_lru(const entry_lru&) = delete;
+    entry_lru& operator=(const entry_lru&) = delete;
+
+    virtual ~entry_lru()
+    {
+      clear_keys();
+    }
+
+    inline size_type max_size() const { return max_size_value::value(); }
+
+  protected:
+    inline virtual size_type size() const override { return size_; }
+
+    inline virtual bool empty() const override { return size_ == 0; }
+
+    inline virtual bool has_key(const key_type& key) const override
+    {
+      const entry_type* entry = ChainedCachingPolicy::find_entry(key);
+      return entry != nullptr && is_linked(*entry);
+    }
+
+    inline virtual bool touch_key(const key_type& key) const override
+    {
+      // pass the touch on to the chained policy
+      if (!ChainedCachingPolicy::touch_key(key))
+        return false;
+
+      // check if we have the key cached
+      entry_type* entry = ChainedCachingPolicy::find_entry(key);
+      if (entry == nullptr || !is_linked(*entry))
+        return false;
+
+      // move it to the front of the list
+      unlink(*entry);
+      link_front(*entry);
+
+      return true;
+    }
+
+    template<typename... Args>
+    inline void insert_key(std::vector<key_type>& expired_keys, const key_type& key, Args&&... args)
+    {
+      // insert the key into the chained policy. the entry has already been created.
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::insert_key(expired_keys, key, std::forward<Args>(args)...);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      entry_type& entry = *ChainedCachingPolicy::find_entry(key);
+
+      // if we already have the key it only has to be moved to the front
+      if (is_linked(entry))
+        unlink(entry);
+      // check if we need to expire a key as well
+      else
+      {
+        if (size_ >= max_size())
+          evict_key(expired_keys);
+
+        ++size_;
+      }
+
+      link_front(entry);
+    }
+
+    inline virtual bool erase_key(const key_type& key) override
+    {
+      entry_type* entry = ChainedCachingPolicy::find_entry(key);
+      if (entry == nullptr || !is_linked(*entry))
+        return false;
+
+      unlink_entry(*entry);
+
+      return true;
+    }
+
+    inline virtual void clear_keys() override
+    {
+      ChainedCachingPolicy::clear_keys();
+
+      // the entries themselves are owned by the entry table
+      head_.prev_ = &head_;
+      head_.next_ = &head_;
+      size_ = 0;
+    }
+
+    virtual void expire_keys(std::vector<key_type>& expired_keys) const override
+    {
+      // expire on the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::expire_keys(expired_keys);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      // nothing else to do because we expire on insert
+    }
+
+    // removes the entry from this and all chained policies
+    inline void unlink_entry(entry_type& entry) const
+    {
+      unlink(entry);
+      --size_;
+
+      ChainedCachingPolicy::unlink_entry(entry);
+    }
+
+    // changes the maximum size of a policy with a dynamic size. the keys
+    // exceeding the new maximum size have to be removed using evict_key()
+    inline void set_max_size(size_type max_size)
+    {
+      static_assert(MaxSize == dynamic, "only a caching policy with a dynamic size can be resized");
+
+      max_size_value::set_value(max_size);
+    }
+
+    // expires the least recently used entry
+    bool evict_key(std::vector<key_type>& expired_keys)
+    {
+      if (size_ == 0)
+        return false;
+
+      entry_type& last_entry = static_cast<entry_type&>(*head_.prev_);
+      expired_keys.push_back(ChainedCachingPolicy::entry_key(last_entry));
+
+      unlink_entry(last_entry);
+
+      return true;
+    }
+
+  private:
+    using max_size_value = policy::dynamic_value<MaxSize, ChainedCachingPolicy>;
+
+    inline static bool is_linked(const entry_lru_hook& hook)
+    {
+      return hook.next_ != nullptr;
+    }
+
+    inline void link_front(entry_lru_hook& hook) const
+    {
+      hook.prev_ = &head_;
+      hook.next_ = head_.next_;
+      head_.next_->prev_ = &hook;
+      head_.next_ = &hook;
+    }
+
+    inline static void unlink(entry_lru_hook& hook)
+    {
+      hook.prev_->next_ = hook.next_;
+      hook.next_->prev_ = hook.prev_;
+      hook.prev_ = nullptr;
+      hook.next_ = nullptr;
+    }
+
+    void erase_keys(const std::vector<key_type>& keys, size_type first_key) const
+    {
+      for (size_type index = first_key; index < keys.size(); ++index)
+      {
+        const key_type& key = keys[index];
+        entry_type* entry = ChainedCachingPolicy::find_entry(key);
+        if (entry == nullptr || !is_linked(*entry))
+          continue;
+
+        unlink(*entry);
+        --size_;
+      }
+    }
+
+    mutable entry_lru_hook head_;
+    mutable size_type size_;
+  };
+}
+}
+
+#endif  // CPP_CACHE_POLICY_ENTRY_LRU_H_
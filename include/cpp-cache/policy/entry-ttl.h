@@ -0,0 +1,421 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ */
+
+#ifndef CPP_CACHE_POLICY_ENTRY_TTL_H_
+#define CPP_CACHE_POLICY_ENTRY_TTL_H_
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "dynamic.h"
+#include "entry.h"
+
+namespace cpp_cache
+{
+namespace policy
+{
+  // deadline and links of an entry in a slot of the timing wheel of an
+  // entry_ttl policy
+  struct entry_ttl_hook
+  {
+    using duration = std::chrono::milliseconds;
+    using tick_type = uint64_t;
+
+    entry_ttl_hook()
+      : duration_()
+      , end_(0)
+      , level_(0)
+      , prev_(nullptr)
+      , next_(nullptr)
+    { }
+
+    duration duration_;
+    tick_type end_;
+    size_t level_;
+    entry_ttl_hook* prev_;
+    entry_ttl_hook* next_;
+  };
+
+  // time-to-live policy keeping the deadlines of the keys in the entries of
+  // the chained entry_table. like policy::ttl the entries are scheduled in a
+  // hierarchical timing wheel but its slots link the entries themselves so
+  // inserting and touching a key is O(1) and expiring only costs the keys
+  // which actually expire (and the occasional cascade).
+  template<class Key, size_t MaxAgeMs, class ChainedCachingPolicy, class Clock = std::chrono::system_clock>
+  class entry_ttl : public ChainedCachingPolicy, private dynamic_value<MaxAgeMs, ChainedCachingPolicy>
+  {
+  private:
+    using time = std::chrono::time_point<Clock>;
+    using duration = entry_ttl_hook::duration;
+    using tick_type = entry_ttl_hook::tick_type;
+
+    // every level has 64 slots each covering 64 times the duration of a slot
+    // of the level below with a resolution of one millisecond (see policy::ttl)
+    static constexpr size_t wheel_bits = 6;
+    static constexpr size_t wheel_size = 1 << wheel_bits;
+    static constexpr size_t wheel_mask = wheel_size - 1;
+    static constexpr size_t wheel_levels = 4;
+
+    // every slot is the head of a circular list of entries
+    using wheel = std::array<entry_ttl_hook, wheel_size>;
+
+  public:
+    using key_type = Key;
+    using age_type = size_t;
+    using duration_type = duration;
+    using size_type = size_t;
+    using entry_type = typename ChainedCachingPolicy::entry_type;
+
+    // touching a key extends its time-to-live and keys expire on their own
+    static constexpr bool shared_reads = false;
+
+    static_assert(std::is_base_of<entry_ttl_hook, entry_type>::value, "entry_ttl requires an entry_table with an entry_ttl_hook");
+
+    template<typename... ChainedArgs, size_t Age = MaxAgeMs, typename std::enable_if<Age != dynamic, int>::type = 0>
+    explicit entry_ttl(ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_age_value(MaxAgeMs)
+      , wheels_()
+      , level_sizes_()
+      , epoch_(Clock::now())
+      , current_tick_(0)
+      , size_(0)
+    {
+      reset_wheels();
+    }
+
+    template<typename... ChainedArgs, size_t Age = MaxAgeMs, typename std::enable_if<Age == dynamic, int>::type = 0>
+    explicit entry_ttl(age_type default_max_age, ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_age_value(default_max_age)
+      , wheels_()
+      , level_sizes_()
+      , epoch_(Clock::now())
+      , current_tick_(0)
+      , size_(0)
+    {
+      reset_wheels();
+    }
+
+    entry_ttl(const entry_ttl&) = delete;
+    entry_ttl& operator=(const entry_ttl&) = delete;
+
+    virtual ~entry_ttl()
+    {
+      clear_keys();
+    }
+
+    inline age_type default_max_age() const { return max_age_value::value(); }
+
+  protected:
+    // changes the maximum age of keys inserted without a maximum age of their
+    // own into a policy with a dynamic default maximum age
+    inline void set_default_max_age(age_type max_age_ms)
+    {
+      static_assert(MaxAgeMs == dynamic, "only a caching policy with a dynamic default maximum age can change it");
+
+      max_age_value::set_value(max_age_ms);
+    }
+
+    inline virtual size_type size() const override { return size_; }
+
+    inline virtual bool empty() const override { return size_ == 0; }
+
+    inline virtual bool has_key(const key_type& key) const override
+    {
+      const entry_type* entry = ChainedCachingPolicy::find_entry(key);
+      return entry != nullptr && is_linked(*entry);
+    }
+
+    inline virtual bool touch_key(const key_type& key) const override
+    {
+      // pass the touch on to the chained policy
+      if (!ChainedCachingPolicy::touch_key(key))
+        return false;
+
+      // try to find the key
+      entry_type* entry = ChainedCachingPolicy::find_entry(key);
+      if (entry == nullptr || !is_linked(*entry))
+        return false;
+
+      // update the end time of the key because it was just used
+      entry_ttl_hook& hook = *entry;
+      unschedule(hook);
+      hook.end_ = to_tick(Clock::now()) + static_cast<tick_type>(hook.duration_.count());
+      schedule(hook);
+
+      return true;
+    }
+
+    template<typename... Args>
+    inline void insert_key(std::vector<key_type>& expired_keys, const key_type& key, Args&&... args)
+    {
+      // insert the key into the chained policy. the entry has already been created.
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::insert_key(expired_keys, key, std::forward<Args>(args)...);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      // pass the call to the proper internal handler relying on SFINAE
+      insert_key_internal(*ChainedCachingPolicy::find_entry(key), std::forward<Args>(args)...);
+    }
+
+    inline virtual bool erase_key(const key_type& key) override
+    {
+      entry_type* entry = ChainedCachingPolicy::find_entry(key);
+      if (entry == nullptr || !is_linked(*entry))
+        return false;
+
+      unlink_entry(*entry);
+
+      return true;
+    }
+
+    inline virtual void clear_keys() override
+    {
+      ChainedCachingPolicy::clear_keys();
+
+      // the entries themselves are owned by the entry table
+      reset_wheels();
+      size_ = 0;
+    }
+
+    virtual void expire_keys(std::vector<key_type>& expired_keys) const override
+    {
+      // expire on the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::expire_keys(expired_keys);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      // advance the timing wheel up to the current time and expire all keys
+      // that have exceeded their time-to-live on the way
+      advance(to_tick(Clock::now()), expired_keys);
+    }
+
+    // removes the entry from this and all chained policies
+    inline void unlink_entry(entry_type& entry) const
+    {
+      unschedule(entry);
+      --size_;
+
+      ChainedCachingPolicy::unlink_entry(entry);
+    }
+
+    // expires one of the entries which are closest to exceeding their time-to-live
+    bool evict_key(std::vector<key_type>& expired_keys)
+    {
+      // the lower levels of the timing wheel hold the entries expiring sooner
+      for (size_t level = 0; level < wheel_levels; ++level)
+      {
+        if (level_sizes_[level] == 0)
+          continue;
+
+        // start with the slot which will be processed next. on the higher
+        // levels the current slot has already been cascaded so it can only
+        // hold entries which wrapped around and is visited last.
+        const size_t current_slot = static_cast<size_t>((current_tick_ >> (wheel_bits * level)) & wheel_mask);
+        const size_t first_slot = level == 0 ? current_slot : current_slot + 1;
+        for (size_t offset = 0; offset < wheel_size; ++offset)
+        {
+          entry_ttl_hook& head = wheels_[level][(first_slot + offset) & wheel_mask];
+          if (head.next_ == &head)
+            continue;
+
+          entry_type& entry = static_cast<entry_type&>(*head.next_);
+          expired_keys.push_back(ChainedCachingPolicy::entry_key(entry));
+
+          unlink_entry(entry);
+
+          return true;
+        }
+      }
+
+      return false;
+    }
+
+  private:
+    using max_age_value = policy::dynamic_value<MaxAgeMs, ChainedCachingPolicy>;
+
+    template<typename... Args>
+    inline void insert_key_internal(entry_type& entry, Args&&... args)
+    {
+      return insert_key_internal(entry, default_max_age(), std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    inline void insert_key_internal(entry_type& entry, age_type max_age_ms, Args&&... args)
+    {
+      return insert_key_internal(entry, duration_type(max_age_ms), std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    inline void insert_key_internal(entry_type& entry, duration_type max_age_duration, Args&&...)
+    {
+      entry_ttl_hook& hook = entry;
+      if (is_linked(hook))
+        unschedule(hook);
+      else
+        ++size_;
+
+      // update the duration and the end time of the key because it was just used
+      hook.duration_ = max_age_duration;
+      hook.end_ = to_tick(Clock::now()) + static_cast<tick_type>(max_age_duration.count());
+      schedule(hook);
+    }
+
+    inline static bool is_linked(const entry_ttl_hook& hook)
+    {
+      return hook.next_ != nullptr;
+    }
+
+    inline tick_type to_tick(const time& point) const
+    {
+      const auto elapsed = std::chrono::duration_cast<duration>(point - epoch_).count();
+      return elapsed < 0 ? 0 : static_cast<tick_type>(elapsed);
+    }
+
+    inline static tick_type level_span(size_t level)
+    {
+      return static_cast<tick_type>(1) << (wheel_bits * level);
+    }
+
+    // determines the level and slot of the wheel in which the entry has to be
+    // processed. an entry is processed in the first tick after its end time.
+    inline void position(const entry_ttl_hook& hook, size_t& level, size_t& slot_index) const
+    {
+      tick_type expiry_tick = std::max(hook.end_ + 1, current_tick_);
+
+      level = 0;
+      while (level < wheel_levels - 1 && expiry_tick - current_tick_ >= level_span(level + 1))
+        ++level;
+
+      // entries beyond the range of the top level are parked in its furthest
+      // slot and will be rescheduled once that slot is cascaded
+      if (expiry_tick - current_tick_ >= level_span(wheel_levels))
+        expiry_tick = current_tick_ + level_span(wheel_levels) - 1;
+
+      slot_index = static_cast<size_t>((expiry_tick >> (wheel_bits * level)) & wheel_mask);
+    }
+
+    inline void schedule(entry_ttl_hook& hook) const
+    {
+      size_t slot_index;
+      position(hook, hook.level_, slot_index);
+
+      entry_ttl_hook& head = wheels_[hook.level_][slot_index];
+      hook.prev_ = head.prev_;
+      hook.next_ = &head;
+      head.prev_->next_ = &hook;
+      head.prev_ = &hook;
+
+      ++level_sizes_[hook.level_];
+    }
+
+    inline void unschedule(entry_ttl_hook& hook) const
+    {
+      hook.prev_->next_ = hook.next_;
+      hook.next_->prev_ = hook.prev_;
+      hook.prev_ = nullptr;
+      hook.next_ = nullptr;
+
+      --level_sizes_[hook.level_];
+    }
+
+    // moves all entries from the current slot of the given level to the levels below
+    void cascade(size_t level) const
+    {
+      const size_t slot_index = static_cast<size_t>((current_tick_ >> (wheel_bits * level)) & wheel_mask);
+
+      // first cascade the level above if this level has completed a full round
+      if (slot_index == 0 && level + 1 < wheel_levels)
+        cascade(level + 1);
+
+      entry_ttl_hook& head = wheels_[level][slot_index];
+      while (head.next_ != &head)
+      {
+        entry_ttl_hook& hook = *head.next_;
+        unschedule(hook);
+        schedule(hook);
+      }
+    }
+
+    void advance(tick_type target_tick, std::vector<key_type>& expired_keys) const
+    {
+      while (current_tick_ <= target_tick)
+      {
+        // nothing to expire
+        if (size_ == 0)
+        {
+          current_tick_ = target_tick + 1;
+          break;
+        }
+
+        const size_t slot_index = static_cast<size_t>(current_tick_ & wheel_mask);
+        if (slot_index == 0)
+          cascade(1);
+
+        // all entries in the current slot of the lowest level have expired
+        entry_ttl_hook& head = wheels_[0][slot_index];
+        while (head.next_ != &head)
+        {
+          entry_type& entry = static_cast<entry_type&>(*head.next_);
+          expired_keys.push_back(ChainedCachingPolicy::entry_key(entry));
+
+          unlink_entry(entry);
+        }
+
+        ++current_tick_;
+
+        // skip ahead to the next cascade if there is nothing on the lowest level
+        if (level_sizes_[0] == 0 && (current_tick_ & wheel_mask) != 0)
+          current_tick_ = std::min(target_tick + 1, (current_tick_ | wheel_mask) + 1);
+      }
+    }
+
+    void reset_wheels() const
+    {
+      for (auto& level : wheels_)
+      {
+        for (auto& head : level)
+        {
+          head.prev_ = &head;
+          head.next_ = &head;
+        }
+      }
+      level_sizes_.fill(0);
+    }
+
+    void erase_keys(const std::vector<key_type>& keys, size_type first_key) const
+    {
+      for (size_type index = first_key; index < keys.size(); ++index)
+      {
+        const key_type& key = keys[index];
+        entry_type* entry = ChainedCachingPolicy::find_entry(key);
+        if (entry == nullptr || !is_linked(*entry))
+          continue;
+
+        unschedule(*entry);
+        --size_;
+      }
+    }
+
+    mutable std::array<wheel, wheel_levels> wheels_;
+    mutable std::array<size_t, wheel_levels> level_sizes_;
+    time epoch_;
+    mutable tick_type current_tick_;
+    mutable size_type size_;
+  };
+}
+}
+
+#endif  // CPP_CACHE_POLICY_ENTRY_TTL_H_
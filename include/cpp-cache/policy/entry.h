@@ -0,0 +1,166 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ */
+
+#ifndef CPP_CACHE_POLICY_ENTRY_H_
+#define CPP_CACHE_POLICY_ENTRY_H_
+
+#include <cstddef>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace cpp_cache
+{
+namespace policy
+{
+  // end of a chain of entry based caching policies (e.g. entry_lru and
+  // entry_ttl) owning a single hash table of entries. every entry contains a
+  // single copy of the key, the cached value and the hooks of all chained
+  // policies so that every operation only needs one hash lookup. it also
+  // stores the cached values for the cache when used with storage::entry.
+  template<class Key, class T, class... Hooks>
+  class entry_table
+  {
+  public:
+    using key_type = Key;
+    using stored_type = T;
+    using size_type = size_t;
+
+    // looking up an entry remembers it
+    static constexpr bool shared_reads = false;
+
+    struct entry_type : public Hooks...
+    {
+      explicit entry_type(const stored_type& value)
+        : Hooks()...
+        , value_(value)
+        , key_(nullptr)
+      { }
+
+      stored_type value_;
+      const key_type* key_;
+    };
+
+    entry_table()
+      : map_()
+      , last_(nullptr)
+    { }
+
+    entry_table(const entry_table&) = delete;
+    entry_table& operator=(const entry_table&) = delete;
+
+    virtual ~entry_table()
+    {
+      clear_keys();
+    }
+
+  private:
+    // helper for unused parameters
+    struct sink
+    {
+      template<typename ...Args>
+      explicit sink(Args&& ... ) { }
+    };
+
+  protected:
+    inline virtual size_type size() const { return map_.size(); }
+
+    inline virtual bool empty() const { return map_.empty(); }
+
+    inline virtual bool has_key(const key_type& key) const { return find_entry(key) != nullptr; }
+
+    inline virtual bool touch_key(const key_type& key) const { return find_entry(key) != nullptr; }
+
+    // the entry has already been created together with its value by
+    // insert_into_storage() and is remembered as the last entry
+    template<typename... Args>
+    inline void insert_key(std::vector<key_type>& expired_keys, const key_type& key, Args&&... args)
+    {
+      sink { expired_keys, key, args... };
+    }
+
+    // the entry stays in the table until it is erased from the storage
+    inline virtual bool erase_key(const key_type& key) { sink { key }; return true; }
+
+    inline virtual void clear_keys() { }
+
+    virtual void expire_keys(std::vector<key_type>& expired_keys) const { sink { expired_keys }; }
+
+    inline bool evict_key(std::vector<key_type>& expired_keys) { sink { expired_keys }; return false; }
+
+    // the hooks of the chained policies have already been unlinked
+    inline void unlink_entry(entry_type& entry) const { sink { entry }; }
+
+    // looks up the entry of the given key. the last entry is remembered so that
+    // all chained policies and the storage share a single hash lookup per key
+    inline entry_type* find_entry(const key_type& key) const
+    {
+      if (last_ != nullptr && map_.key_eq()(*last_->key_, key))
+        return last_;
+
+      auto it = map_.find(key);
+      if (it == map_.end())
+        return nullptr;
+
+      last_ = &it->second;
+      return last_;
+    }
+
+    inline static const key_type& entry_key(const entry_type& entry) { return *entry.key_; }
+
+    const stored_type* find_in_storage(const key_type& key) const
+    {
+      const entry_type* entry = find_entry(key);
+      if (entry == nullptr)
+        return nullptr;
+
+      return &entry->value_;
+    }
+
+    // called before insert_key() so that the value of a new entry is
+    // constructed in place
+    void insert_into_storage(const key_type& key, const stored_type& value)
+    {
+      // the value of the last entry (e.g. after a lookup) is replaced without
+      // any hash lookup
+      if (last_ != nullptr && map_.key_eq()(*last_->key_, key))
+      {
+        last_->value_ = value;
+        return;
+      }
+
+      // a single hash lookup both finds an existing entry and creates a new one
+      auto result = map_.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(value));
+      if (result.second)
+        result.first->second.key_ = &result.first->first;
+      else
+        result.first->second.value_ = value;
+      last_ = &result.first->second;
+    }
+
+    void erase_from_storage(const key_type& key) const
+    {
+      if (last_ != nullptr && map_.key_eq()(*last_->key_, key))
+        last_ = nullptr;
+
+      map_.erase(key);
+    }
+
+    inline void clear_storage()
+    {
+      last_ = nullptr;
+      map_.clear();
+    }
+
+  private:
+    using map = std::unordered_map<key_type, entry_type>;
+
+    mutable map map_;
+    mutable entry_type* last_;
+  };
+}
+}
+
+#endif  // CPP_CACHE_POLICY_ENTRY_H_
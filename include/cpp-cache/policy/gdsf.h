@@ -0,0 +1,302 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ */
+
+#ifndef CPP_CACHE_POLICY_GDSF_H_
+#define CPP_CACHE_POLICY_GDSF_H_
+
+#include <cstddef>
+#include <map>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "dynamic.h"
+#include "none.h"
+
+namespace cpp_cache
+{
+namespace policy
+{
+  // greedy dual size frequency policy for values which differ in the cost of
+  // fetching them and in their size. every key has the priority
+  // L + frequency * cost / size and the key with the lowest priority is
+  // evicted. the inflation value L is raised to the priority of every evicted
+  // key so that keys which haven't been used for a long time age out.
+  // the cost and the size of a key are passed to insert() after the value as
+  // numbers (converted to cost_type and object_size_type) and both default to 1.
+  template<class Key, size_t MaxSize, class ChainedCachingPolicy = none<Key, size_t>>
+  class gdsf : public ChainedCachingPolicy, private dynamic_value<MaxSize, ChainedCachingPolicy>
+  {
+  public:
+    using key_type = Key;
+    using size_type = size_t;
+    using cost_type = double;
+    using object_size_type = size_t;
+    using priority_type = double;
+    using frequency_type = size_t;
+
+    // touching a key increases its frequency and priority
+    static constexpr bool shared_reads = false;
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size != dynamic, int>::type = 0>
+    explicit gdsf(ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(MaxSize)
+      , priorities_()
+      , map_()
+      , inflation_(0)
+    {
+      map_.reserve(MaxSize);
+    }
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size == dynamic, int>::type = 0>
+    explicit gdsf(size_type max_size, ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(max_size)
+      , priorities_()
+      , map_()
+      , inflation_(0)
+    {
+      map_.reserve(max_size);
+    }
+
+    virtual ~gdsf()
+    {
+      clear_keys();
+    }
+
+    inline size_type max_size() const { return max_size_value::value(); }
+
+    // the priority of the last evicted key
+    inline priority_type inflation() const { return inflation_; }
+
+  protected:
+    inline virtual size_type size() const override { return map_.size(); }
+
+    inline virtual bool empty() const override { return map_.empty(); }
+
+    inline virtual bool has_key(const key_type& key) const override
+    {
+      return map_.find(key) != map_.cend();
+    }
+
+    inline virtual bool touch_key(const key_type& key) const override
+    {
+      // pass the touch on to the chained policy
+      if (!ChainedCachingPolicy::touch_key(key))
+        return false;
+
+      // check if we have the key cached
+      auto it = map_.find(key);
+      if (it == map_.cend())
+        return false;
+
+      ++it->second.frequency_;
+      reprioritize(it->first, it->second);
+
+      return true;
+    }
+
+    template<typename... Args>
+    inline void insert_key(std::vector<key_type>& expired_keys, const key_type& key, Args&&... args)
+    {
+      // insert the key into the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::insert_key(expired_keys, key, std::forward<Args>(args)...);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      // pass the call to the proper internal handler relying on SFINAE
+      insert_key_internal(expired_keys, key, std::forward<Args>(args)...);
+    }
+
+    inline virtual bool erase_key(const key_type& key) override
+    {
+      auto it = map_.find(key);
+      if (it == map_.cend())
+        return false;
+
+      ChainedCachingPolicy::erase_key(key);
+      erase_entry(it);
+
+      return true;
+    }
+
+    inline virtual void clear_keys() override
+    {
+      ChainedCachingPolicy::clear_keys();
+
+      map_.clear();
+      priorities_.clear();
+      inflation_ = 0;
+    }
+
+    virtual void expire_keys(std::vector<key_type>& expired_keys) const override
+    {
+      // expire on the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::expire_keys(expired_keys);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      // nothing else to do because we expire on insert
+    }
+
+    // changes the maximum size of a policy with a dynamic size. the keys
+    // exceeding the new maximum size have to be removed using evict_key()
+    inline void set_max_size(size_type max_size)
+    {
+      static_assert(MaxSize == dynamic, "only a caching policy with a dynamic size can be resized");
+
+      max_size_value::set_value(max_size);
+    }
+
+    // expires the key with the lowest priority and inflates the priority of
+    // all keys inserted or touched from now on
+    bool evict_key(std::vector<key_type>& expired_keys)
+    {
+      if (priorities_.empty())
+        return false;
+
+      auto lowest = priorities_.begin();
+      inflation_ = lowest->first;
+
+      const key_type key = lowest->second;
+      ChainedCachingPolicy::erase_key(key);
+      erase_entry(map_.find(key));
+
+      expired_keys.push_back(key);
+
+      return true;
+    }
+
+  private:
+    using max_size_value = policy::dynamic_value<MaxSize, ChainedCachingPolicy>;
+
+    // keys with the same priority are ordered by their insertion
+    using priority_map = std::multimap<priority_type, key_type>;
+    using priority_iterator = typename priority_map::iterator;
+
+    struct gdsf_key
+    {
+      frequency_type frequency_;
+      cost_type cost_;
+      object_size_type object_size_;
+      priority_iterator position_;
+    };
+
+    using map = std::unordered_map<key_type, gdsf_key>;
+    using map_iterator = typename map::iterator;
+
+    inline bool is_full() const
+    {
+      return map_.size() >= max_size();
+    }
+
+    // any number may be passed as the cost and the size of a key so that
+    // e.g. an int literal isn't silently skipped as an unrelated argument
+    template<typename Arg>
+    using is_number = std::is_arithmetic<typename std::decay<Arg>::type>;
+
+    inline void insert_key_internal(std::vector<key_type>& expired_keys, const key_type& key)
+    {
+      return insert_key_weighted(expired_keys, key, cost_type(1), object_size_type(1));
+    }
+
+    template<typename Cost, typename... Args, typename std::enable_if<is_number<Cost>::value, int>::type = 0>
+    inline void insert_key_internal(std::vector<key_type>& expired_keys, const key_type& key, Cost&& cost, Args&&... args)
+    {
+      return insert_key_sized(expired_keys, key, static_cast<cost_type>(cost), std::forward<Args>(args)...);
+    }
+
+    template<typename Arg, typename... Args, typename std::enable_if<!is_number<Arg>::value, int>::type = 0>
+    inline void insert_key_internal(std::vector<key_type>& expired_keys, const key_type& key, Arg&&, Args&&...)
+    {
+      return insert_key_weighted(expired_keys, key, cost_type(1), object_size_type(1));
+    }
+
+    inline void insert_key_sized(std::vector<key_type>& expired_keys, const key_type& key, cost_type cost)
+    {
+      return insert_key_weighted(expired_keys, key, cost, object_size_type(1));
+    }
+
+    template<typename ObjectSize, typename... Args, typename std::enable_if<is_number<ObjectSize>::value, int>::type = 0>
+    inline void insert_key_sized(std::vector<key_type>& expired_keys, const key_type& key, cost_type cost, ObjectSize&& object_size, Args&&...)
+    {
+      static_assert(sizeof...(Args) == 0, "gdsf only takes a cost and a size after the value");
+
+      return insert_key_weighted(expired_keys, key, cost, static_cast<object_size_type>(object_size));
+    }
+
+    template<typename Arg, typename... Args, typename std::enable_if<!is_number<Arg>::value, int>::type = 0>
+    inline void insert_key_sized(std::vector<key_type>& expired_keys, const key_type& key, cost_type cost, Arg&&, Args&&...)
+    {
+      return insert_key_weighted(expired_keys, key, cost, object_size_type(1));
+    }
+
+    void insert_key_weighted(std::vector<key_type>& expired_keys, const key_type& key, cost_type cost, object_size_type object_size)
+    {
+      // if we already have the key it counts as a touch with the new cost and size
+      auto it = map_.find(key);
+      if (it != map_.end())
+      {
+        ++it->second.frequency_;
+        it->second.cost_ = cost;
+        it->second.object_size_ = object_size;
+        reprioritize(it->first, it->second);
+        return;
+      }
+
+      // check if we need to expire a key as well
+      if (is_full())
+        evict_key(expired_keys);
+
+      gdsf_key entry { 1, cost, object_size, priority_iterator() };
+      entry.position_ = priorities_.insert(std::make_pair(priority(entry), key));
+      map_.insert(std::make_pair(key, entry));
+    }
+
+    inline priority_type priority(const gdsf_key& entry) const
+    {
+      // a size of zero is treated like the smallest possible size
+      const object_size_type object_size = entry.object_size_ > 0 ? entry.object_size_ : 1;
+      return inflation_ + static_cast<priority_type>(entry.frequency_) * entry.cost_ / static_cast<priority_type>(object_size);
+    }
+
+    inline void reprioritize(const key_type& key, gdsf_key& entry) const
+    {
+      priorities_.erase(entry.position_);
+      entry.position_ = priorities_.insert(std::make_pair(priority(entry), key));
+    }
+
+    inline void erase_entry(map_iterator it) const
+    {
+      priorities_.erase(it->second.position_);
+      map_.erase(it);
+    }
+
+    void erase_keys(const std::vector<key_type>& keys, size_type first_key) const
+    {
+      for (size_type index = first_key; index < keys.size(); ++index)
+      {
+        const key_type& key = keys[index];
+        auto it = map_.find(key);
+        if (it == map_.end())
+          continue;
+
+        erase_entry(it);
+      }
+    }
+
+    mutable priority_map priorities_;
+    mutable map map_;
+    priority_type inflation_;
+  };
+}
+}
+
+#endif  // CPP_CACHE_POLICY_GDSF_H_
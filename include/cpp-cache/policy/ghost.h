@@ -0,0 +1,100 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ */
+
+#ifndef CPP_CACHE_POLICY_GHOST_H_
+#define CPP_CACHE_POLICY_GHOST_H_
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <unordered_map>
+
+namespace cpp_cache
+{
+namespace policy
+{
+  // list of recently evicted keys used by caching policies which adapt to the
+  // keys they have seen before (e.g. arc). only a fingerprint (the hash) of
+  // every key is kept so the memory used doesn't depend on the key type. two
+  // keys with the same fingerprint are treated as the same key.
+  template<class Key, class Hash = std::hash<Key>>
+  class ghost_list
+  {
+  public:
+    using key_type = Key;
+    using size_type = size_t;
+    using fingerprint_type = size_t;
+
+    ghost_list()
+      : list_()
+      , map_()
+      , hash_()
+    { }
+
+    inline size_type size() const { return list_.size(); }
+
+    inline bool empty() const { return list_.empty(); }
+
+    inline bool contains(const key_type& key) const
+    {
+      return map_.find(hash_(key)) != map_.cend();
+    }
+
+    // adds the key as the most recently evicted one
+    void push(const key_type& key)
+    {
+      const fingerprint_type fingerprint = hash_(key);
+
+      auto it = map_.find(fingerprint);
+      if (it != map_.end())
+      {
+        list_.splice(list_.begin(), list_, it->second);
+        return;
+      }
+
+      list_.push_front(fingerprint);
+      map_[fingerprint] = list_.begin();
+    }
+
+    // removes the key and returns whether it was in the list
+    bool erase(const key_type& key)
+    {
+      auto it = map_.find(hash_(key));
+      if (it == map_.end())
+        return false;
+
+      list_.erase(it->second);
+      map_.erase(it);
+
+      return true;
+    }
+
+    // forgets the key which was evicted the longest time ago
+    void pop()
+    {
+      if (list_.empty())
+        return;
+
+      map_.erase(list_.back());
+      list_.pop_back();
+    }
+
+    void clear()
+    {
+      map_.clear();
+      list_.clear();
+    }
+
+  private:
+    using list = std::list<fingerprint_type>;
+    using map = std::unordered_map<fingerprint_type, typename list::iterator>;
+
+    list list_;
+    map map_;
+    Hash hash_;
+  };
+}
+}
+
+#endif  // CPP_CACHE_POLICY_GHOST_H_
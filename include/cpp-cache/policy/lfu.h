@@ -2,14 +2,18 @@
  *  Copyright (C) Sascha Montellese
  */
 
-#ifndef CPP_CACHE_POLICY_LRU_H_
-#define CPP_CACHE_POLICY_LRU_H_
+#ifndef CPP_CACHE_POLICY_LFU_H_
+#define CPP_CACHE_POLICY_LFU_H_
 
 #include <cstddef>
+#include <iterator>
 #include <list>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "dynamic.h"
 #include "none.h"
 
 namespace cpp_cache
@@ -17,23 +21,42 @@ namespace cpp_cache
 namespace policy
 {
   template<class Key, size_t MaxSize, class ChainedCachingPolicy = none<Key, size_t>>
-  class lfu : protected ChainedCachingPolicy
+  class lfu : public ChainedCachingPolicy, private dynamic_value<MaxSize, ChainedCachingPolicy>
   {
   public:
     using key_type = Key;
     using size_type = size_t;
+    using frequency_type = size_t;
 
-    lfu()
-      : list_()
+    // touching a key increases its frequency
+    static constexpr bool shared_reads = false;
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size != dynamic, int>::type = 0>
+    explicit lfu(ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(MaxSize)
+      , buckets_()
       , map_()
-    { }
+    {
+      map_.reserve(MaxSize);
+    }
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size == dynamic, int>::type = 0>
+    explicit lfu(size_type max_size, ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(max_size)
+      , buckets_()
+      , map_()
+    {
+      map_.reserve(max_size);
+    }
 
     virtual ~lfu()
     {
       clear_keys();
     }
 
-    inline virtual size_type max_size() const { return MaxSize; }
+    inline size_type max_size() const { return max_size_value::value(); }
 
   protected:
     inline virtual size_type size() const override { return map_.size(); }
@@ -45,48 +68,52 @@ namespace policy
       return map_.find(key) != map_.cend();
     }
 
-    inline virtual void get_key(const key_type& key) const override
+    inline virtual bool touch_key(const key_type& key) const override
     {
-      // first pass the action on to the chained policy
-      ChainedCachingPolicy::get_key(key);
+      // pass the touch on to the chained policy
+      if (!ChainedCachingPolicy::touch_key(key))
+        return false;
+
+      // check if we have the key cached
+      auto it = map_.find(key);
+      if (it == map_.cend())
+        return false;
+
+      // the key has been used once more
+      increment_frequency(it->second);
 
-      // now move the (recently) used key to the front
-      auto list_it = map_.at(key);
-      list_.splice(list_.begin(), list_, list_it);
+      return true;
     }
 
-    inline virtual std::vector<key_type> insert_key(const key_type& key) override
+    template<typename... Args>
+    inline void insert_key(std::vector<key_type>& expired_keys, const key_type& key, Args&&... args)
     {
       // insert the key into the chained policy
-      std::vector<key_type> expired_keys = ChainedCachingPolicy::insert_key(key);
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::insert_key(expired_keys, key, std::forward<Args>(args)...);
 
       // remove all the keys that were expired in the chained policy
-      erase_keys(expired_keys);
-
-      // add the key to the front of the list (most recently used)
-      list_.push_front(key);
+      erase_keys(expired_keys, first_expired_key);
 
-      // if we already have the key we need to remove it from the list because
-      // we just added it to the front
+      // if we already have the key inserting it again counts as another use
       auto it = map_.find(key);
       if (it != map_.cend())
-        list_.erase(it->second);
-
-      // add / update the key in the map
-      map_[key] = list_.begin();
+      {
+        increment_frequency(it->second);
+        return;
+      }
 
       // check if we need to expire a key as well
-      if (is_too_full())
-      {
-        // expire the last key in the list
-        key_type last_key = list_.back();
-        map_.erase(last_key);
-        list_.pop_back();
+      if (is_full())
+        evict_key(expired_keys);
 
-        expired_keys.push_back(last_key);
-      }
+      // new keys always start in the bucket with a frequency of one
+      if (buckets_.empty() || buckets_.front().frequency != 1)
+        buckets_.emplace_front(1);
 
-      return expired_keys;
+      auto bucket_it = buckets_.begin();
+      bucket_it->keys.push_front(key);
+      map_.insert(std::make_pair(key, entry { bucket_it, bucket_it->keys.begin() }));
     }
 
     inline virtual bool erase_key(const key_type& key) override
@@ -97,7 +124,7 @@ namespace policy
 
       ChainedCachingPolicy::erase_key(key);
 
-      list_.erase(it->second);
+      erase_from_bucket(it->second.bucket, it->second.key);
       map_.erase(it);
 
       return true;
@@ -108,48 +135,127 @@ namespace policy
       ChainedCachingPolicy::clear_keys();
 
       map_.clear();
-      list_.clear();
+      buckets_.clear();
     }
 
-    virtual std::vector<key_type> expire_keys() const override
+    virtual void expire_keys(std::vector<key_type>& expired_keys) const override
     {
       // expire on the chained policy
-      std::vector<key_type> expired_keys = ChainedCachingPolicy::expire_keys();
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::expire_keys(expired_keys);
 
       // remove all the keys that were expired in the chained policy
-      erase_keys(expired_keys);
+      erase_keys(expired_keys, first_expired_key);
 
       // nothing else to do because we expire on insert
-      return expired_keys;
+    }
+
+    // changes the maximum size of a policy with a dynamic size. the keys
+    // exceeding the new maximum size have to be removed using evict_key()
+    inline void set_max_size(size_type max_size)
+    {
+      static_assert(MaxSize == dynamic, "only a caching policy with a dynamic size can be resized");
+
+      max_size_value::set_value(max_size);
+    }
+
+    // expires the least recently used key with the lowest frequency
+    bool evict_key(std::vector<key_type>& expired_keys)
+    {
+      if (buckets_.empty())
+        return false;
+
+      auto bucket_it = buckets_.begin();
+      const key_type least_key = bucket_it->keys.back();
+
+      ChainedCachingPolicy::erase_key(least_key);
+      erase_from_bucket(bucket_it, std::prev(bucket_it->keys.end()));
+      map_.erase(least_key);
+
+      expired_keys.push_back(least_key);
+
+      return true;
     }
 
   private:
+    using max_size_value = policy::dynamic_value<MaxSize, ChainedCachingPolicy>;
+
     using list = std::list<key_type>;
     using list_iterator = typename list::iterator;
-    using map = std::unordered_map<key_type, list_iterator>;
 
-    inline bool is_too_full() const
+    // all keys with the same frequency ordered from most to least recently used
+    struct bucket
+    {
+      explicit bucket(frequency_type frequency_)
+        : frequency(frequency_)
+        , keys()
+      { }
+
+      frequency_type frequency;
+      list keys;
+    };
+
+    // buckets ordered by ascending frequency
+    using bucket_list = std::list<bucket>;
+    using bucket_iterator = typename bucket_list::iterator;
+
+    struct entry
+    {
+      bucket_iterator bucket;
+      list_iterator key;
+    };
+
+    using map = std::unordered_map<key_type, entry>;
+
+    inline bool is_full() const
+    {
+      return map_.size() >= max_size();
+    }
+
+    void increment_frequency(entry& key_entry) const
+    {
+      auto bucket_it = key_entry.bucket;
+      auto next_bucket_it = std::next(bucket_it);
+
+      // make sure there is a bucket for the next higher frequency
+      const frequency_type frequency = bucket_it->frequency + 1;
+      if (next_bucket_it == buckets_.end() || next_bucket_it->frequency != frequency)
+        next_bucket_it = buckets_.emplace(next_bucket_it, frequency);
+
+      // move the key to the front of the next bucket without any reallocation
+      next_bucket_it->keys.splice(next_bucket_it->keys.begin(), bucket_it->keys, key_entry.key);
+      key_entry.bucket = next_bucket_it;
+
+      // get rid of the old bucket if it isn't used anymore
+      if (bucket_it->keys.empty())
+        buckets_.erase(bucket_it);
+    }
+
+    inline void erase_from_bucket(bucket_iterator bucket_it, list_iterator list_it) const
     {
-      return size() > max_size();
+      bucket_it->keys.erase(list_it);
+      if (bucket_it->keys.empty())
+        buckets_.erase(bucket_it);
     }
 
-    void erase_keys(const std::vector<key_type>& keys) const
+    void erase_keys(const std::vector<key_type>& keys, size_type first_key) const
     {
-      for (const auto& key : keys)
+      for (size_type index = first_key; index < keys.size(); ++index)
       {
+        const key_type& key = keys[index];
         auto it = map_.find(key);
         if (it == map_.cend())
           continue;
 
-        list_.erase(it->second);
+        erase_from_bucket(it->second.bucket, it->second.key);
         map_.erase(it);
       }
     }
 
-    mutable list list_;
+    mutable bucket_list buckets_;
     mutable map map_;
   };
 }
 }
 
-#endif  // CPP_CACHE_POLICY_LRU_H_
+#endif  // CPP_CACHE_POLICY_LFU_H_
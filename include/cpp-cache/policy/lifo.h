@@ -5,12 +5,14 @@
 #ifndef CPP_CACHE_POLICY_LIFO_H_
 #define CPP_CACHE_POLICY_LIFO_H_
 
-#include <algorithm>
 #include <cstddef>
-#include <deque>
+#include <list>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "dynamic.h"
 #include "none.h"
 
 namespace cpp_cache
@@ -18,31 +20,50 @@ namespace cpp_cache
 namespace policy
 {
   template<class Key, size_t MaxSize, class ChainedCachingPolicy = none<Key, size_t>>
-  class lifo : public ChainedCachingPolicy
+  class lifo : public ChainedCachingPolicy, private dynamic_value<MaxSize, ChainedCachingPolicy>
   {
   public:
     using key_type = Key;
     using size_type = size_t;
 
-    lifo()
-      : queue_()
-    { }
+    // looking up or touching keys doesn't modify the policy
+    static constexpr bool shared_reads = cpp_cache::detail::shared_reads<ChainedCachingPolicy>::value;
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size != dynamic, int>::type = 0>
+    explicit lifo(ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(MaxSize)
+      , queue_()
+      , map_()
+    {
+      map_.reserve(MaxSize);
+    }
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size == dynamic, int>::type = 0>
+    explicit lifo(size_type max_size, ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(max_size)
+      , queue_()
+      , map_()
+    {
+      map_.reserve(max_size);
+    }
 
     virtual ~lifo()
     {
       clear_keys();
     }
 
-    inline virtual size_type max_size() const { return MaxSize; }
+    inline size_type max_size() const { return max_size_value::value(); }
 
   protected:
-    inline virtual size_type size() const override { return queue_.size(); }
+    inline virtual size_type size() const override { return map_.size(); }
 
-    inline virtual bool empty() const override { return queue_.empty(); }
+    inline virtual bool empty() const override { return map_.empty(); }
 
     inline virtual bool has_key(const key_type& key) const override
     {
-      return find(key) != queue_.cend();
+      return map_.find(key) != map_.cend();
     }
 
     inline virtual bool touch_key(const key_type& key) const override
@@ -55,40 +76,38 @@ namespace policy
     }
 
     template<typename... Args>
-    inline std::vector<key_type> insert_key(const key_type& key, Args&&... args)
+    inline void insert_key(std::vector<key_type>& expired_keys, const key_type& key, Args&&... args)
     {
       // insert the key into the chained policy
-      std::vector<key_type> expired_keys = ChainedCachingPolicy::insert_key(key, std::forward<Args>(args)...);
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::insert_key(expired_keys, key, std::forward<Args>(args)...);
 
       // remove all the keys that were expired in the chained policy
-      expire_keys(expired_keys);
+      expire_keys(expired_keys, first_expired_key);
 
       // if we already have the key there's nothing to do
       if (has_key(key))
-        return expired_keys;
+        return;
 
       // check if we need to expire a key as well
       if (is_full())
-      {
-        // expire the first key in the queue
-        expired_keys.push_back(queue_.front());
-        queue_.pop_front();
-      }
+        evict_key(expired_keys);
 
       // insert the new key at the beginning
       queue_.push_front(key);
-
-      return expired_keys;
+      map_[key] = queue_.begin();
     }
 
     inline virtual bool erase_key(const key_type& key) override
     {
-      auto it = find(key);
-      if (it == queue_.cend())
+      auto it = map_.find(key);
+      if (it == map_.cend())
         return false;
 
       ChainedCachingPolicy::erase_key(key);
-      queue_.erase(it);
+
+      queue_.erase(it->second);
+      map_.erase(it);
 
       return true;
     }
@@ -96,41 +115,77 @@ namespace policy
     inline virtual void clear_keys() override
     {
       ChainedCachingPolicy::clear_keys();
+
+      map_.clear();
       queue_.clear();
     }
 
-    virtual std::vector<key_type> expire_keys() const override
+    virtual void expire_keys(std::vector<key_type>& expired_keys) const override
     {
       // expire on the chained policy
-      std::vector<key_type> expired_keys = ChainedCachingPolicy::expire_keys();
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::expire_keys(expired_keys);
 
       // remove all the keys that were expired in the chained policy
-      expire_keys(expired_keys);
+      expire_keys(expired_keys, first_expired_key);
 
       // nothing else to do because we expire on insert
-      return expired_keys;
     }
 
-  private:
-    using queue = std::deque<key_type>;
+    // changes the maximum size of a policy with a dynamic size. the keys
+    // exceeding the new maximum size have to be removed using evict_key()
+    inline void set_max_size(size_type max_size)
+    {
+      static_assert(MaxSize == dynamic, "only a caching policy with a dynamic size can be resized");
 
-    inline bool is_full() const
+      max_size_value::set_value(max_size);
+    }
+
+    // expires the first (newest) key in the queue
+    bool evict_key(std::vector<key_type>& expired_keys)
     {
-      return size() >= max_size();
+      if (queue_.empty())
+        return false;
+
+      const key_type first_key = queue_.front();
+      ChainedCachingPolicy::erase_key(first_key);
+
+      map_.erase(first_key);
+      queue_.pop_front();
+
+      expired_keys.push_back(first_key);
+
+      return true;
     }
 
-    inline typename queue::const_iterator find(const key_type& key) const
+  private:
+    using max_size_value = policy::dynamic_value<MaxSize, ChainedCachingPolicy>;
+
+    using queue = std::list<key_type>;
+    using queue_iterator = typename queue::iterator;
+    using map = std::unordered_map<key_type, queue_iterator>;
+
+    inline bool is_full() const
     {
-      return std::find(queue_.cbegin(), queue_.cend(), key);
+      return map_.size() >= max_size();
     }
 
-    void expire_keys(const std::vector<key_type>& keys) const
+    void expire_keys(const std::vector<key_type>& keys, size_type first_key) const
     {
-      for (const auto& key : keys)
-        queue_.erase(find(key));
+      for (size_type index = first_key; index < keys.size(); ++index)
+      {
+        const key_type& key = keys[index];
+        auto it = map_.find(key);
+        if (it == map_.cend())
+          continue;
+
+        queue_.erase(it->second);
+        map_.erase(it);
+      }
     }
 
     mutable queue queue_;
+    mutable map map_;
   };
 }
 }
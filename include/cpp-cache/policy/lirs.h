@@ -0,0 +1,396 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ */
+
+#ifndef CPP_CACHE_POLICY_LIRS_H_
+#define CPP_CACHE_POLICY_LIRS_H_
+
+#include <cstddef>
+#include <list>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "dynamic.h"
+#include "none.h"
+
+namespace cpp_cache
+{
+namespace policy
+{
+  // low inter-reference recency set policy. most of the cache (all but 1% of
+  // the maximum size) is reserved for keys with a low inter-reference
+  // recency (LIR), i.e. keys which have been used again shortly after their
+  // previous use. all other keys (HIR) are kept in a small queue and evicted
+  // from there. the stack S orders LIR keys, resident HIR keys and recently
+  // evicted (non-resident) HIR keys by their recency. a HIR key used again
+  // while it is in S becomes a LIR key and the least recent LIR key at the
+  // bottom of S becomes a HIR key instead. non-resident keys only keep their
+  // key and are limited to the maximum size.
+  template<class Key, size_t MaxSize, class ChainedCachingPolicy = none<Key, size_t>>
+  class lirs : public ChainedCachingPolicy, private dynamic_value<MaxSize, ChainedCachingPolicy>
+  {
+  public:
+    using key_type = Key;
+    using size_type = size_t;
+
+    // touching a key moves it to the top of the stack
+    static constexpr bool shared_reads = false;
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size != dynamic, int>::type = 0>
+    explicit lirs(ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(MaxSize)
+      , stack_()
+      , queue_()
+      , non_resident_()
+      , map_()
+      , lir_count_(0)
+    {
+      map_.reserve(MaxSize);
+    }
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size == dynamic, int>::type = 0>
+    explicit lirs(size_type max_size, ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(max_size)
+      , stack_()
+      , queue_()
+      , non_resident_()
+      , map_()
+      , lir_count_(0)
+    {
+      map_.reserve(max_size);
+    }
+
+    virtual ~lirs()
+    {
+      clear_keys();
+    }
+
+    inline size_type max_size() const { return max_size_value::value(); }
+
+  protected:
+    inline virtual size_type size() const override { return lir_count_ + queue_.size(); }
+
+    inline virtual bool empty() const override { return size() == 0; }
+
+    inline virtual bool has_key(const key_type& key) const override
+    {
+      auto it = map_.find(key);
+      return it != map_.cend() && it->second.status_ != status::non_resident;
+    }
+
+    inline virtual bool touch_key(const key_type& key) const override
+    {
+      // pass the touch on to the chained policy
+      if (!ChainedCachingPolicy::touch_key(key))
+        return false;
+
+      // check if we have the key cached
+      auto it = map_.find(key);
+      if (it == map_.cend() || it->second.status_ == status::non_resident)
+        return false;
+
+      access(it->first, it->second);
+
+      return true;
+    }
+
+    template<typename... Args>
+    inline void insert_key(std::vector<key_type>& expired_keys, const key_type& key, Args&&... args)
+    {
+      // insert the key into the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::insert_key(expired_keys, key, std::forward<Args>(args)...);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      // if we already have the key it counts as a touch
+      if (has_key(key))
+      {
+        auto it = map_.find(key);
+        access(it->first, it->second);
+        return;
+      }
+
+      // check if we need to expire a key as well
+      if (is_full())
+        evict_key(expired_keys);
+
+      // a non-resident key has been used again while it was in the stack
+      auto it = map_.find(key);
+      if (it != map_.end())
+      {
+        non_resident_.erase(it->second.queue_position_);
+        make_lir(it->first, it->second);
+        return;
+      }
+
+      it = map_.emplace(key, entry()).first;
+
+      // as long as there is room all keys become LIR keys
+      if (lir_count_ < lir_size())
+      {
+        it->second.status_ = status::lir;
+        ++lir_count_;
+        push_on_stack(it->first, it->second);
+      }
+      else
+      {
+        it->second.status_ = status::hir;
+        push_on_stack(it->first, it->second);
+        it->second.queue_position_ = queue_.insert(queue_.end(), key);
+      }
+    }
+
+    inline virtual bool erase_key(const key_type& key) override
+    {
+      auto it = map_.find(key);
+      if (it == map_.cend() || it->second.status_ == status::non_resident)
+        return false;
+
+      ChainedCachingPolicy::erase_key(key);
+
+      erase_entry(it);
+
+      return true;
+    }
+
+    inline virtual void clear_keys() override
+    {
+      ChainedCachingPolicy::clear_keys();
+
+      map_.clear();
+      stack_.clear();
+      queue_.clear();
+      non_resident_.clear();
+      lir_count_ = 0;
+    }
+
+    virtual void expire_keys(std::vector<key_type>& expired_keys) const override
+    {
+      // expire on the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::expire_keys(expired_keys);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      // nothing else to do because we expire on insert
+    }
+
+    // changes the maximum size of a policy with a dynamic size. the keys
+    // exceeding the new maximum size have to be removed using evict_key()
+    inline void set_max_size(size_type max_size)
+    {
+      static_assert(MaxSize == dynamic, "only a caching policy with a dynamic size can be resized");
+
+      max_size_value::set_value(max_size);
+    }
+
+    // expires the oldest resident HIR key which stays in the stack as a
+    // non-resident key if it is still in there
+    bool evict_key(std::vector<key_type>& expired_keys)
+    {
+      if (empty())
+        return false;
+
+      // without any HIR keys the least recent LIR key has to go
+      if (queue_.empty())
+        demote_bottom();
+
+      const key_type key = queue_.front();
+      queue_.pop_front();
+
+      ChainedCachingPolicy::erase_key(key);
+      expired_keys.push_back(key);
+
+      auto it = map_.find(key);
+      if (!it->second.in_stack_)
+      {
+        map_.erase(it);
+        return true;
+      }
+
+      it->second.status_ = status::non_resident;
+      it->second.queue_position_ = non_resident_.insert(non_resident_.end(), key);
+
+      // forget the oldest non-resident keys
+      while (non_resident_.size() > max_size())
+      {
+        auto oldest = map_.find(non_resident_.front());
+        stack_.erase(oldest->second.stack_position_);
+        map_.erase(oldest);
+        non_resident_.pop_front();
+      }
+
+      return true;
+    }
+
+  private:
+    using max_size_value = policy::dynamic_value<MaxSize, ChainedCachingPolicy>;
+
+    enum class status
+    {
+      lir,
+      hir,
+      non_resident
+    };
+
+    using list = std::list<key_type>;
+    using list_iterator = typename list::iterator;
+
+    struct entry
+    {
+      entry()
+        : status_(status::hir)
+        , in_stack_(false)
+        , stack_position_()
+        , queue_position_()
+      { }
+
+      status status_;
+      bool in_stack_;
+      list_iterator stack_position_;
+      // position in the queue of resident HIR keys or of non-resident keys
+      list_iterator queue_position_;
+    };
+
+    using map = std::unordered_map<key_type, entry>;
+    using map_iterator = typename map::iterator;
+
+    inline bool is_full() const
+    {
+      return size() >= max_size();
+    }
+
+    inline size_type hir_size() const
+    {
+      const size_type size = max_size() / 100;
+      return size > 0 ? size : 1;
+    }
+
+    inline size_type lir_size() const
+    {
+      return max_size() > hir_size() ? max_size() - hir_size() : 0;
+    }
+
+    void access(const key_type& key, entry& key_entry) const
+    {
+      if (key_entry.status_ == status::lir)
+      {
+        push_on_stack(key, key_entry);
+        prune();
+      }
+      // a HIR key in the stack has a lower inter-reference recency than the
+      // LIR key at the bottom of the stack
+      else if (key_entry.in_stack_)
+      {
+        queue_.erase(key_entry.queue_position_);
+        make_lir(key, key_entry);
+      }
+      else
+      {
+        push_on_stack(key, key_entry);
+        queue_.splice(queue_.end(), queue_, key_entry.queue_position_);
+      }
+    }
+
+    void make_lir(const key_type& key, entry& key_entry) const
+    {
+      key_entry.status_ = status::lir;
+      ++lir_count_;
+      push_on_stack(key, key_entry);
+
+      while (lir_count_ > lir_size() && lir_count_ > 0)
+        demote_bottom();
+    }
+
+    inline void push_on_stack(const key_type& key, entry& key_entry) const
+    {
+      if (key_entry.in_stack_)
+        stack_.splice(stack_.begin(), stack_, key_entry.stack_position_);
+      else
+      {
+        key_entry.stack_position_ = stack_.insert(stack_.begin(), key);
+        key_entry.in_stack_ = true;
+      }
+    }
+
+    // turns the LIR key at the bottom of the stack into a HIR key
+    void demote_bottom() const
+    {
+      prune();
+
+      auto it = map_.find(stack_.back());
+      stack_.pop_back();
+      it->second.in_stack_ = false;
+      it->second.status_ = status::hir;
+      it->second.queue_position_ = queue_.insert(queue_.end(), it->first);
+      --lir_count_;
+
+      prune();
+    }
+
+    // removes all HIR keys from the bottom of the stack so that it always
+    // ends with a LIR key
+    void prune() const
+    {
+      while (!stack_.empty())
+      {
+        auto it = map_.find(stack_.back());
+        if (it->second.status_ == status::lir)
+          break;
+
+        stack_.pop_back();
+        it->second.in_stack_ = false;
+
+        if (it->second.status_ == status::non_resident)
+        {
+          non_resident_.erase(it->second.queue_position_);
+          map_.erase(it);
+        }
+      }
+    }
+
+    void erase_entry(map_iterator it) const
+    {
+      if (it->second.status_ == status::lir)
+        --lir_count_;
+      else
+        queue_.erase(it->second.queue_position_);
+
+      if (it->second.in_stack_)
+        stack_.erase(it->second.stack_position_);
+
+      map_.erase(it);
+
+      prune();
+    }
+
+    void erase_keys(const std::vector<key_type>& keys, size_type first_key) const
+    {
+      for (size_type index = first_key; index < keys.size(); ++index)
+      {
+        const key_type& key = keys[index];
+        auto it = map_.find(key);
+        if (it == map_.end() || it->second.status_ == status::non_resident)
+          continue;
+
+        erase_entry(it);
+      }
+    }
+
+    mutable list stack_;
+    mutable list queue_;
+    mutable list non_resident_;
+    mutable map map_;
+    mutable size_type lir_count_;
+  };
+}
+}
+
+#endif  // CPP_CACHE_POLICY_LIRS_H_
@@ -0,0 +1,352 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ */
+
+#ifndef CPP_CACHE_POLICY_LRU_K_H_
+#define CPP_CACHE_POLICY_LRU_K_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <map>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "dynamic.h"
+#include "none.h"
+
+namespace cpp_cache
+{
+namespace policy
+{
+  // LRU-K remembers the times of the last K uses of every key and evicts the
+  // key whose K-th most recent use is the oldest. keys which have been used
+  // less than K times are evicted first (least recently used first). uses of
+  // a key within CorrelatedPeriod uses of the cache after its last use are
+  // considered to be correlated (e.g. a burst of reads of the same page) and
+  // only count as a single use. keys are not evicted during their correlated
+  // period unless all keys are in it. the history of evicted keys is kept for
+  // up to the maximum size of keys so that keys used again soon keep their
+  // history.
+  template<class Key, size_t MaxSize, size_t K = 2, size_t CorrelatedPeriod = 0, class ChainedCachingPolicy = none<Key, size_t>>
+  class lru_k : public ChainedCachingPolicy, private dynamic_value<MaxSize, ChainedCachingPolicy>
+  {
+  public:
+    using key_type = Key;
+    using size_type = size_t;
+
+    static_assert(K > 0, "at least the last use of a key has to be remembered");
+
+    // touching a key updates its history
+    static constexpr bool shared_reads = false;
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size != dynamic, int>::type = 0>
+    explicit lru_k(ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(MaxSize)
+      , priorities_()
+      , map_()
+      , ghosts_()
+      , ghost_order_()
+      , clock_(0)
+    {
+      map_.reserve(MaxSize);
+    }
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size == dynamic, int>::type = 0>
+    explicit lru_k(size_type max_size, ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(max_size)
+      , priorities_()
+      , map_()
+      , ghosts_()
+      , ghost_order_()
+      , clock_(0)
+    {
+      map_.reserve(max_size);
+    }
+
+    virtual ~lru_k()
+    {
+      clear_keys();
+    }
+
+    inline size_type max_size() const { return max_size_value::value(); }
+
+  protected:
+    inline virtual size_type size() const override { return map_.size(); }
+
+    inline virtual bool empty() const override { return map_.empty(); }
+
+    inline virtual bool has_key(const key_type& key) const override
+    {
+      return map_.find(key) != map_.cend();
+    }
+
+    inline virtual bool touch_key(const key_type& key) const override
+    {
+      // pass the touch on to the chained policy
+      if (!ChainedCachingPolicy::touch_key(key))
+        return false;
+
+      // check if we have the key cached
+      auto it = map_.find(key);
+      if (it == map_.cend())
+        return false;
+
+      access(it->first, it->second);
+
+      return true;
+    }
+
+    template<typename... Args>
+    inline void insert_key(std::vector<key_type>& expired_keys, const key_type& key, Args&&... args)
+    {
+      // insert the key into the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::insert_key(expired_keys, key, std::forward<Args>(args)...);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      // if we already have the key it counts as a touch
+      auto it = map_.find(key);
+      if (it != map_.end())
+      {
+        access(it->first, it->second);
+        return;
+      }
+
+      // the key is used now so a key used just before can be in its
+      // correlated period
+      ++clock_;
+
+      // check if we need to expire a key as well
+      if (is_full())
+        evict_key(expired_keys);
+
+      it = map_.insert(std::make_pair(key, lru_k_key())).first;
+
+      // continue the history of a recently evicted key
+      auto ghost = ghosts_.find(key);
+      if (ghost != ghosts_.end())
+      {
+        it->second.history_ = ghost->second.history_;
+        ghost_order_.erase(ghost->second.position_);
+        ghosts_.erase(ghost);
+
+        record(it->second.history_);
+      }
+      else
+      {
+        it->second.history_.uses_[0] = clock_;
+        it->second.history_.last_ = clock_;
+      }
+
+      it->second.position_ = priorities_.insert(std::make_pair(priority(it->second.history_), it->first));
+    }
+
+    inline virtual bool erase_key(const key_type& key) override
+    {
+      auto it = map_.find(key);
+      if (it == map_.cend())
+        return false;
+
+      ChainedCachingPolicy::erase_key(key);
+      erase_entry(it);
+
+      return true;
+    }
+
+    inline virtual void clear_keys() override
+    {
+      ChainedCachingPolicy::clear_keys();
+
+      map_.clear();
+      priorities_.clear();
+      ghosts_.clear();
+      ghost_order_.clear();
+      clock_ = 0;
+    }
+
+    virtual void expire_keys(std::vector<key_type>& expired_keys) const override
+    {
+      // expire on the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::expire_keys(expired_keys);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      // nothing else to do because we expire on insert
+    }
+
+    // changes the maximum size of a policy with a dynamic size. the keys
+    // exceeding the new maximum size have to be removed using evict_key()
+    inline void set_max_size(size_type max_size)
+    {
+      static_assert(MaxSize == dynamic, "only a caching policy with a dynamic size can be resized");
+
+      max_size_value::set_value(max_size);
+    }
+
+    // expires the key with the oldest K-th most recent use outside of its
+    // correlated period and remembers its history
+    bool evict_key(std::vector<key_type>& expired_keys)
+    {
+      if (map_.empty())
+        return false;
+
+      auto victim = priorities_.begin();
+      for (auto it = victim; it != priorities_.end(); ++it)
+      {
+        if (clock_ - map_.find(it->second)->second.history_.last_ > CorrelatedPeriod)
+        {
+          victim = it;
+          break;
+        }
+      }
+
+      const key_type key = victim->second;
+      ChainedCachingPolicy::erase_key(key);
+
+      auto it = map_.find(key);
+      remember(key, it->second.history_);
+      erase_entry(it);
+
+      expired_keys.push_back(key);
+
+      return true;
+    }
+
+  private:
+    using max_size_value = policy::dynamic_value<MaxSize, ChainedCachingPolicy>;
+
+    using tick_type = uint64_t;
+
+    struct history
+    {
+      history()
+        : uses_()
+        , last_(0)
+      {
+        uses_.fill(0);
+      }
+
+      // the times of the last K uncorrelated uses starting with the most
+      // recent one. zero means that there haven't been enough uses.
+      std::array<tick_type, K> uses_;
+      // the time of the last (possibly correlated) use
+      tick_type last_;
+    };
+
+    // the K-th most recent use followed by the most recent use
+    using priority_type = std::pair<tick_type, tick_type>;
+    using priority_map = std::multimap<priority_type, key_type>;
+    using priority_iterator = typename priority_map::iterator;
+
+    struct lru_k_key
+    {
+      history history_;
+      priority_iterator position_;
+    };
+
+    using map = std::unordered_map<key_type, lru_k_key>;
+    using map_iterator = typename map::iterator;
+
+    using list = std::list<key_type>;
+    using list_iterator = typename list::iterator;
+
+    struct ghost
+    {
+      history history_;
+      list_iterator position_;
+    };
+
+    using ghost_map = std::unordered_map<key_type, ghost>;
+
+    inline bool is_full() const
+    {
+      return map_.size() >= max_size();
+    }
+
+    inline static priority_type priority(const history& key_history)
+    {
+      return priority_type(key_history.uses_[K - 1], key_history.uses_[0]);
+    }
+
+    // records a use of a key at the current time
+    void record(history& key_history) const
+    {
+      // a correlated use only extends the correlated period
+      if (clock_ - key_history.last_ <= CorrelatedPeriod)
+      {
+        key_history.last_ = clock_;
+        return;
+      }
+
+      // the previous uses are moved forward by the length of the last
+      // correlated period so that it only counts as a single use
+      const tick_type correlated_period = key_history.last_ - key_history.uses_[0];
+      for (size_t index = K - 1; index > 0; --index)
+        key_history.uses_[index] = key_history.uses_[index - 1] != 0 ? key_history.uses_[index - 1] + correlated_period : 0;
+
+      key_history.uses_[0] = clock_;
+      key_history.last_ = clock_;
+    }
+
+    void access(const key_type& key, lru_k_key& entry) const
+    {
+      ++clock_;
+      record(entry.history_);
+
+      priorities_.erase(entry.position_);
+      entry.position_ = priorities_.insert(std::make_pair(priority(entry.history_), key));
+    }
+
+    // keeps the history of an evicted key and forgets the oldest histories
+    void remember(const key_type& key, const history& key_history)
+    {
+      ghost_order_.push_back(key);
+      ghosts_[key] = ghost { key_history, std::prev(ghost_order_.end()) };
+
+      while (ghost_order_.size() > max_size())
+      {
+        ghosts_.erase(ghost_order_.front());
+        ghost_order_.pop_front();
+      }
+    }
+
+    inline void erase_entry(map_iterator it) const
+    {
+      priorities_.erase(it->second.position_);
+      map_.erase(it);
+    }
+
+    void erase_keys(const std::vector<key_type>& keys, size_type first_key) const
+    {
+      for (size_type index = first_key; index < keys.size(); ++index)
+      {
+        const key_type& key = keys[index];
+        auto it = map_.find(key);
+        if (it == map_.end())
+          continue;
+
+        erase_entry(it);
+      }
+    }
+
+    mutable priority_map priorities_;
+    mutable map map_;
+    ghost_map ghosts_;
+    list ghost_order_;
+    mutable tick_type clock_;
+  };
+}
+}
+
+#endif  // CPP_CACHE_POLICY_LRU_K_H_
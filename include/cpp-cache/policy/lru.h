@@ -7,10 +7,12 @@
 
 #include <cstddef>
 #include <list>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "dynamic.h"
 #include "none.h"
 
 namespace cpp_cache
@@ -18,25 +20,41 @@ namespace cpp_cache
 namespace policy
 {
   template<class Key, size_t MaxSize, class ChainedCachingPolicy = none<Key, size_t>>
-  class lru : public ChainedCachingPolicy
+  class lru : public ChainedCachingPolicy, private dynamic_value<MaxSize, ChainedCachingPolicy>
   {
   public:
     using key_type = Key;
     using size_type = size_t;
 
-    lru()
-      : list_()
+    // touching a key moves it to the front of the list
+    static constexpr bool shared_reads = false;
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size != dynamic, int>::type = 0>
+    explicit lru(ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(MaxSize)
+      , list_()
       , map_()
     {
       map_.reserve(MaxSize);
     }
 
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size == dynamic, int>::type = 0>
+    explicit lru(size_type max_size, ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(max_size)
+      , list_()
+      , map_()
+    {
+      map_.reserve(max_size);
+    }
+
     virtual ~lru()
     {
       clear_keys();
     }
 
-    inline virtual size_type max_size() const { return MaxSize; }
+    inline size_type max_size() const { return max_size_value::value(); }
 
   protected:
     inline virtual size_type size() const override { return map_.size(); }
@@ -66,37 +84,30 @@ namespace policy
     }
 
     template<typename... Args>
-    inline std::vector<key_type> insert_key(const key_type& key, Args&&... args)
+    inline void insert_key(std::vector<key_type>& expired_keys, const key_type& key, Args&&... args)
     {
       // insert the key into the chained policy
-      std::vector<key_type> expired_keys = ChainedCachingPolicy::insert_key(key, std::forward<Args>(args)...);
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::insert_key(expired_keys, key, std::forward<Args>(args)...);
 
       // remove all the keys that were expired in the chained policy
-      erase_keys(expired_keys);
-
-      // add the key to the front of the list (most recently used)
-      list_.push_front(key);
+      erase_keys(expired_keys, first_expired_key);
 
-      // if we already have the key we need to remove it from the list because
-      // we just added it to the front
+      // if we already have the key it only has to be moved to the front
       auto it = map_.find(key);
       if (it != map_.cend())
-        list_.erase(it->second);
-      // check if we need to expire a key as well
-      else if (is_full())
       {
-        // expire the last key in the list
-        key_type last_key = list_.back();
-        map_.erase(last_key);
-        list_.pop_back();
-
-        expired_keys.push_back(last_key);
+        move_key_to_front(it->second);
+        return;
       }
 
-      // add / update the key in the map
-      map_[key] = list_.begin();
+      // check if we need to expire a key as well
+      if (is_full())
+        evict_key(expired_keys);
 
-      return expired_keys;
+      // add the key to the front of the list (most recently used)
+      list_.push_front(key);
+      map_[key] = list_.begin();
     }
 
     inline virtual bool erase_key(const key_type& key) override
@@ -121,26 +132,54 @@ namespace policy
       list_.clear();
     }
 
-    virtual std::vector<key_type> expire_keys() const override
+    virtual void expire_keys(std::vector<key_type>& expired_keys) const override
     {
       // expire on the chained policy
-      std::vector<key_type> expired_keys = ChainedCachingPolicy::expire_keys();
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::expire_keys(expired_keys);
 
       // remove all the keys that were expired in the chained policy
-      erase_keys(expired_keys);
+      erase_keys(expired_keys, first_expired_key);
 
       // nothing else to do because we expire on insert
-      return expired_keys;
+    }
+
+    // changes the maximum size of a policy with a dynamic size. the keys
+    // exceeding the new maximum size have to be removed using evict_key()
+    inline void set_max_size(size_type max_size)
+    {
+      static_assert(MaxSize == dynamic, "only a caching policy with a dynamic size can be resized");
+
+      max_size_value::set_value(max_size);
+    }
+
+    // expires the least recently used key
+    bool evict_key(std::vector<key_type>& expired_keys)
+    {
+      if (list_.empty())
+        return false;
+
+      const key_type last_key = list_.back();
+      ChainedCachingPolicy::erase_key(last_key);
+
+      map_.erase(last_key);
+      list_.pop_back();
+
+      expired_keys.push_back(last_key);
+
+      return true;
     }
 
   private:
+    using max_size_value = policy::dynamic_value<MaxSize, ChainedCachingPolicy>;
+
     using list = std::list<key_type>;
     using list_iterator = typename list::iterator;
     using map = std::unordered_map<key_type, list_iterator>;
 
     inline bool is_full() const
     {
-      return size() >= max_size();
+      return map_.size() >= max_size();
     }
 
     inline void move_key_to_front(list_iterator list_it) const
@@ -148,10 +187,11 @@ namespace policy
       list_.splice(list_.begin(), list_, list_it);
     }
 
-    void erase_keys(const std::vector<key_type>& keys) const
+    void erase_keys(const std::vector<key_type>& keys, size_type first_key) const
     {
-      for (const auto& key : keys)
+      for (size_type index = first_key; index < keys.size(); ++index)
       {
+        const key_type& key = keys[index];
         auto it = map_.find(key);
         if (it == map_.cend())
           continue;
@@ -5,6 +5,9 @@
 #ifndef CPP_CACHE_POLICY_NONE_H_
 #define CPP_CACHE_POLICY_NONE_H_
 
+#include <type_traits>
+#include <vector>
+
 namespace cpp_cache
 {
 namespace policy
@@ -37,15 +40,35 @@ namespace policy
     inline virtual bool touch_key(const key_type& key) const { sink { key }; return true; }
 
     template<typename... Args>
-    inline std::vector<key_type> insert_key(const key_type& key, Args&&... args) { sink { key, args... }; return {}; }
+    inline void insert_key(std::vector<key_type>& expired_keys, const key_type& key, Args&&... args) { sink { expired_keys, key, args... }; }
 
     inline virtual bool erase_key(const key_type& key) { sink { key }; return true; }
 
     inline virtual void clear_keys() { }
 
-    virtual std::vector<key_type> expire_keys() const { return {}; }
+    virtual void expire_keys(std::vector<key_type>& expired_keys) const { sink { expired_keys }; }
+
+    inline bool evict_key(std::vector<key_type>& expired_keys) { sink { expired_keys }; return false; }
   };
 }
+
+namespace detail
+{
+  // caching policies defining shared_reads can look up and touch keys from
+  // multiple threads at the same time and never expire keys on their own
+  template<class CachingPolicy, class = void>
+  struct shared_reads : std::false_type
+  { };
+
+  template<class CachingPolicy>
+  struct shared_reads<CachingPolicy, typename std::enable_if<CachingPolicy::shared_reads>::type> : std::true_type
+  { };
+
+  // looking up or touching keys doesn't modify the none policy
+  template<class Key, typename SizeType>
+  struct shared_reads<policy::none<Key, SizeType>> : std::true_type
+  { };
+}
 }
 
 #endif  // CPP_CACHE_POLICY_NONE_H_
@@ -7,10 +7,12 @@
 
 #include <cstddef>
 #include <random>
-#include <unordered_set>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "dynamic.h"
 #include "none.h"
 
 namespace cpp_cache
@@ -18,17 +20,37 @@ namespace cpp_cache
 namespace policy
 {
   template<class Key, size_t MaxSize, class ChainedCachingPolicy = none<Key, size_t>>
-  class random : public ChainedCachingPolicy
+  class random : public ChainedCachingPolicy, private dynamic_value<MaxSize, ChainedCachingPolicy>
   {
   public:
     using key_type = Key;
     using size_type = size_t;
 
-    random()
-      : set_()
+    // looking up or touching keys doesn't modify the policy
+    static constexpr bool shared_reads = cpp_cache::detail::shared_reads<ChainedCachingPolicy>::value;
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size != dynamic, int>::type = 0>
+    explicit random(ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(MaxSize)
+      , keys_()
+      , map_()
+      , rand_(rd_())
+    {
+      keys_.reserve(MaxSize);
+      map_.reserve(MaxSize);
+    }
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size == dynamic, int>::type = 0>
+    explicit random(size_type max_size, ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(max_size)
+      , keys_()
+      , map_()
       , rand_(rd_())
     {
-      set_.reserve(MaxSize);
+      keys_.reserve(max_size);
+      map_.reserve(max_size);
     }
 
     virtual ~random()
@@ -36,16 +58,16 @@ namespace policy
       clear_keys();
     }
 
-    inline virtual size_type max_size() const { return MaxSize; }
+    inline size_type max_size() const { return max_size_value::value(); }
 
   protected:
-    inline virtual size_type size() const override { return set_.size(); }
+    inline virtual size_type size() const override { return keys_.size(); }
 
-    inline virtual bool empty() const override { return set_.empty(); }
+    inline virtual bool empty() const override { return keys_.empty(); }
 
     inline virtual bool has_key(const key_type& key) const override
     {
-      return set_.find(key) != set_.cend();
+      return map_.find(key) != map_.cend();
     }
 
     inline virtual bool touch_key(const key_type& key) const override
@@ -58,45 +80,36 @@ namespace policy
     }
 
     template<typename... Args>
-    inline std::vector<key_type> insert_key(const key_type& key, Args&&... args)
+    inline void insert_key(std::vector<key_type>& expired_keys, const key_type& key, Args&&... args)
     {
       // insert the key into the chained policy
-      std::vector<key_type> expired_keys = ChainedCachingPolicy::insert_key(key, std::forward<Args>(args)...);
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::insert_key(expired_keys, key, std::forward<Args>(args)...);
 
       // remove all the keys that were expired in the chained policy
-      erase_keys(expired_keys);
+      erase_keys(expired_keys, first_expired_key);
 
       // if we already have the key there's nothing to do
       if (has_key(key))
-        return expired_keys;
+        return;
 
       // check if we need to expire a key as well
       if (is_full())
-      {
-        // expire a random key in the set
-        std::uniform_int_distribution<size_type> dist(0, size() - 1);
-        auto it = set_.cbegin();
-        std::advance(it, dist(rand_));
-
-        expired_keys.push_back(*it);
-
-        set_.erase(it);
-      }
+        evict_key(expired_keys);
 
-      // insert the new key at the beginning
-      set_.insert(key);
-
-      return expired_keys;
+      // append the new key
+      map_.insert(std::make_pair(key, keys_.size()));
+      keys_.push_back(key);
     }
 
     inline virtual bool erase_key(const key_type& key) override
     {
-      auto it = set_.find(key);
-      if (it == set_.cend())
+      auto it = map_.find(key);
+      if (it == map_.cend())
         return false;
 
       ChainedCachingPolicy::erase_key(key);
-      set_.erase(it);
+      erase_at(it->second);
 
       return true;
     }
@@ -104,40 +117,92 @@ namespace policy
     inline virtual void clear_keys() override
     {
       ChainedCachingPolicy::clear_keys();
-      set_.clear();
+
+      map_.clear();
+      keys_.clear();
     }
 
-    virtual std::vector<key_type> expire_keys() const override
+    virtual void expire_keys(std::vector<key_type>& expired_keys) const override
     {
       // expire on the chained policy
-      std::vector<key_type> expired_keys = ChainedCachingPolicy::expire_keys();
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::expire_keys(expired_keys);
 
       // remove all the keys that were expired in the chained policy
-      erase_keys(expired_keys);
+      erase_keys(expired_keys, first_expired_key);
 
       // nothing else to do because we expire on insert
-      return expired_keys;
+    }
+
+    // changes the maximum size of a policy with a dynamic size. the keys
+    // exceeding the new maximum size have to be removed using evict_key()
+    inline void set_max_size(size_type max_size)
+    {
+      static_assert(MaxSize == dynamic, "only a caching policy with a dynamic size can be resized");
+
+      max_size_value::set_value(max_size);
+    }
+
+    // expires a random key
+    bool evict_key(std::vector<key_type>& expired_keys)
+    {
+      if (keys_.empty())
+        return false;
+
+      std::uniform_int_distribution<size_type> dist(0, keys_.size() - 1);
+      const size_type index = dist(rand_);
+
+      expired_keys.push_back(keys_[index]);
+
+      ChainedCachingPolicy::erase_key(keys_[index]);
+      erase_at(index);
+
+      return true;
     }
 
   private:
-    using set = std::unordered_set<key_type>;
+    using max_size_value = policy::dynamic_value<MaxSize, ChainedCachingPolicy>;
+
+    using map = std::unordered_map<key_type, size_type>;
 
     inline bool is_full() const
     {
-      return size() >= max_size();
+      return keys_.size() >= max_size();
     }
 
-    void erase_keys(const std::vector<key_type>& keys) const
+    // removes the key at the given index by moving the last key into its place
+    inline void erase_at(size_type index) const
     {
-      for (const auto& key : keys)
-        set_.erase(key);
+      map_.erase(keys_[index]);
+
+      if (index != keys_.size() - 1)
+      {
+        keys_[index] = std::move(keys_.back());
+        map_[keys_[index]] = index;
+      }
+
+      keys_.pop_back();
+    }
+
+    void erase_keys(const std::vector<key_type>& keys, size_type first_key) const
+    {
+      for (size_type index = first_key; index < keys.size(); ++index)
+      {
+        const key_type& key = keys[index];
+        auto it = map_.find(key);
+        if (it == map_.cend())
+          continue;
+
+        erase_at(it->second);
+      }
     }
 
-    mutable set set_;
+    mutable std::vector<key_type> keys_;
+    mutable map map_;
     std::random_device rd_;
     std::default_random_engine rand_;
   };
 }
 }
 
-#endif  // CPP_CACHE_POLICY_LRU_H_
+#endif  // CPP_CACHE_POLICY_RANDOM_H_
@@ -0,0 +1,343 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ */
+
+#ifndef CPP_CACHE_POLICY_S3FIFO_H_
+#define CPP_CACHE_POLICY_S3FIFO_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "dynamic.h"
+#include "none.h"
+
+namespace cpp_cache
+{
+namespace policy
+{
+  // S3-FIFO keeps new keys in a small probationary queue (10% of the maximum
+  // size). keys which haven't been touched by the time they reach the end of
+  // that queue are evicted and remembered in a ghost queue while all others
+  // are moved to the main queue. keys found in the ghost queue are inserted
+  // straight into the main queue. the main queue reinserts keys as long as
+  // their (2-bit) frequency hasn't dropped to zero.
+  template<class Key, size_t MaxSize, class ChainedCachingPolicy = none<Key, size_t>>
+  class s3fifo : public ChainedCachingPolicy, private dynamic_value<MaxSize, ChainedCachingPolicy>
+  {
+  public:
+    using key_type = Key;
+    using size_type = size_t;
+
+    // touching a key only increments an atomic frequency
+    static constexpr bool shared_reads = cpp_cache::detail::shared_reads<ChainedCachingPolicy>::value;
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size != dynamic, int>::type = 0>
+    explicit s3fifo(ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(MaxSize)
+      , small_()
+      , main_()
+      , map_()
+      , ghost_()
+      , ghost_map_()
+    {
+      map_.reserve(MaxSize);
+    }
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size == dynamic, int>::type = 0>
+    explicit s3fifo(size_type max_size, ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(max_size)
+      , small_()
+      , main_()
+      , map_()
+      , ghost_()
+      , ghost_map_()
+    {
+      map_.reserve(max_size);
+    }
+
+    virtual ~s3fifo()
+    {
+      clear_keys();
+    }
+
+    inline size_type max_size() const { return max_size_value::value(); }
+
+  protected:
+    inline virtual size_type size() const override { return map_.size(); }
+
+    inline virtual bool empty() const override { return map_.empty(); }
+
+    inline virtual bool has_key(const key_type& key) const override
+    {
+      return map_.find(key) != map_.cend();
+    }
+
+    inline virtual bool touch_key(const key_type& key) const override
+    {
+      // pass the touch on to the chained policy
+      if (!ChainedCachingPolicy::touch_key(key))
+        return false;
+
+      // check if we have the key cached
+      auto it = map_.find(key);
+      if (it == map_.cend())
+        return false;
+
+      it->second->touch();
+
+      return true;
+    }
+
+    template<typename... Args>
+    inline void insert_key(std::vector<key_type>& expired_keys, const key_type& key, Args&&... args)
+    {
+      // insert the key into the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::insert_key(expired_keys, key, std::forward<Args>(args)...);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      // if we already have the key it counts as a touch
+      auto it = map_.find(key);
+      if (it != map_.cend())
+      {
+        it->second->touch();
+        return;
+      }
+
+      // keys which have been evicted recently go straight into the main queue
+      const bool in_main = forget(key);
+
+      // check if we need to expire a key as well
+      if (is_full())
+        evict_key(expired_keys);
+
+      queue& keys = in_main ? main_ : small_;
+      keys.emplace_front(key, in_main);
+      map_[key] = keys.begin();
+    }
+
+    inline virtual bool erase_key(const key_type& key) override
+    {
+      auto it = map_.find(key);
+      if (it == map_.cend())
+        return false;
+
+      ChainedCachingPolicy::erase_key(key);
+
+      erase_entry(it);
+
+      return true;
+    }
+
+    inline virtual void clear_keys() override
+    {
+      ChainedCachingPolicy::clear_keys();
+
+      map_.clear();
+      small_.clear();
+      main_.clear();
+      ghost_map_.clear();
+      ghost_.clear();
+    }
+
+    virtual void expire_keys(std::vector<key_type>& expired_keys) const override
+    {
+      // expire on the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::expire_keys(expired_keys);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      // nothing else to do because we expire on insert
+    }
+
+    // changes the maximum size of a policy with a dynamic size. the keys
+    // exceeding the new maximum size have to be removed using evict_key()
+    inline void set_max_size(size_type max_size)
+    {
+      static_assert(MaxSize == dynamic, "only a caching policy with a dynamic size can be resized");
+
+      max_size_value::set_value(max_size);
+    }
+
+    // expires a key from the small queue if it has reached its share of the
+    // maximum size and otherwise from the main queue
+    bool evict_key(std::vector<key_type>& expired_keys)
+    {
+      if (map_.empty())
+        return false;
+
+      while (true)
+      {
+        if (small_.size() >= small_size() || main_.empty())
+        {
+          // keys touched while in the small queue are moved to the main queue
+          entry& last = small_.back();
+          if (last.frequency() > 0)
+          {
+            last.reset_frequency();
+            last.in_main_ = true;
+            main_.splice(main_.begin(), small_, std::prev(small_.end()));
+            continue;
+          }
+
+          const key_type key = last.key_;
+          evict_entry(map_.find(key), expired_keys);
+          remember(key);
+
+          return true;
+        }
+
+        // keys with a frequency left are reinserted into the main queue
+        entry& last = main_.back();
+        if (last.frequency() > 0)
+        {
+          last.decrement_frequency();
+          main_.splice(main_.begin(), main_, std::prev(main_.end()));
+          continue;
+        }
+
+        evict_entry(map_.find(last.key_), expired_keys);
+
+        return true;
+      }
+    }
+
+  private:
+    using max_size_value = policy::dynamic_value<MaxSize, ChainedCachingPolicy>;
+
+    static constexpr uint8_t max_frequency = 3;
+
+    struct entry
+    {
+      entry(const key_type& key, bool in_main)
+        : key_(key)
+        , frequency_(0)
+        , in_main_(in_main)
+      { }
+
+      inline void touch()
+      {
+        // concurrent touches may get lost which doesn't matter for a frequency
+        // that is capped at 3 anyway
+        const uint8_t frequency = frequency_.load(std::memory_order_relaxed);
+        if (frequency < max_frequency)
+          frequency_.store(frequency + 1, std::memory_order_relaxed);
+      }
+
+      inline uint8_t frequency() const { return frequency_.load(std::memory_order_relaxed); }
+
+      inline void decrement_frequency() { frequency_.store(frequency() - 1, std::memory_order_relaxed); }
+
+      inline void reset_frequency() { frequency_.store(0, std::memory_order_relaxed); }
+
+      key_type key_;
+      std::atomic<uint8_t> frequency_;
+      bool in_main_;
+    };
+
+    using queue = std::list<entry>;
+    using queue_iterator = typename queue::iterator;
+    using map = std::unordered_map<key_type, queue_iterator>;
+    using map_iterator = typename map::iterator;
+    using ghost_queue = std::list<key_type>;
+    using ghost_map = std::unordered_map<key_type, typename ghost_queue::iterator>;
+
+    inline bool is_full() const
+    {
+      return map_.size() >= max_size();
+    }
+
+    inline size_type small_size() const
+    {
+      const size_type size = max_size() / 10;
+      return size > 0 ? size : 1;
+    }
+
+    // the ghost queue remembers as many keys as fit into the main queue
+    inline size_type ghost_size() const
+    {
+      const size_type size = max_size() - small_size();
+      return size > 0 ? size : 1;
+    }
+
+    inline void erase_entry(map_iterator it) const
+    {
+      if (it->second->in_main_)
+        main_.erase(it->second);
+      else
+        small_.erase(it->second);
+
+      map_.erase(it);
+    }
+
+    inline void evict_entry(map_iterator it, std::vector<key_type>& expired_keys)
+    {
+      const key_type key = it->first;
+      ChainedCachingPolicy::erase_key(key);
+
+      erase_entry(it);
+
+      expired_keys.push_back(key);
+    }
+
+    // removes the key from the ghost queue and returns whether it was in it
+    inline bool forget(const key_type& key)
+    {
+      auto it = ghost_map_.find(key);
+      if (it == ghost_map_.end())
+        return false;
+
+      ghost_.erase(it->second);
+      ghost_map_.erase(it);
+
+      return true;
+    }
+
+    inline void remember(const key_type& key)
+    {
+      while (ghost_.size() >= ghost_size())
+      {
+        ghost_map_.erase(ghost_.back());
+        ghost_.pop_back();
+      }
+
+      ghost_.push_front(key);
+      ghost_map_[key] = ghost_.begin();
+    }
+
+    void erase_keys(const std::vector<key_type>& keys, size_type first_key) const
+    {
+      for (size_type index = first_key; index < keys.size(); ++index)
+      {
+        const key_type& key = keys[index];
+        auto it = map_.find(key);
+        if (it == map_.end())
+          continue;
+
+        erase_entry(it);
+      }
+    }
+
+    mutable queue small_;
+    mutable queue main_;
+    mutable map map_;
+    ghost_queue ghost_;
+    ghost_map ghost_map_;
+  };
+}
+}
+
+#endif  // CPP_CACHE_POLICY_S3FIFO_H_
@@ -0,0 +1,347 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ */
+
+#ifndef CPP_CACHE_POLICY_SAMPLED_LRU_H_
+#define CPP_CACHE_POLICY_SAMPLED_LRU_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "dynamic.h"
+#include "none.h"
+
+namespace cpp_cache
+{
+namespace policy
+{
+  // approximation of a least recently used policy which only keeps a 32-bit
+  // access time per key instead of a linked list. the access time is a
+  // logical clock advancing with every inserted key. on eviction Samples
+  // random keys are looked at and the least recently used one of them (or of
+  // the best candidates kept from previous evictions) is evicted.
+  template<class Key, size_t MaxSize, size_t Samples = 5, class ChainedCachingPolicy = none<Key, size_t>>
+  class sampled_lru : public ChainedCachingPolicy, private dynamic_value<MaxSize, ChainedCachingPolicy>
+  {
+  public:
+    using key_type = Key;
+    using size_type = size_t;
+
+    static_assert(Samples > 0, "at least one key has to be sampled");
+
+    // touching a key only stores its access time
+    static constexpr bool shared_reads = cpp_cache::detail::shared_reads<ChainedCachingPolicy>::value;
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size != dynamic, int>::type = 0>
+    explicit sampled_lru(ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(MaxSize)
+      , slots_()
+      , map_()
+      , pool_()
+      , clock_(0)
+      , rand_(std::random_device()())
+    {
+      slots_.reserve(MaxSize);
+      map_.reserve(MaxSize);
+      pool_.reserve(pool_size);
+    }
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size == dynamic, int>::type = 0>
+    explicit sampled_lru(size_type max_size, ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(max_size)
+      , slots_()
+      , map_()
+      , pool_()
+      , clock_(0)
+      , rand_(std::random_device()())
+    {
+      slots_.reserve(max_size);
+      map_.reserve(max_size);
+      pool_.reserve(pool_size);
+    }
+
+    virtual ~sampled_lru()
+    {
+      clear_keys();
+    }
+
+    inline size_type max_size() const { return max_size_value::value(); }
+
+  protected:
+    inline virtual size_type size() const override { return slots_.size(); }
+
+    inline virtual bool empty() const override { return slots_.empty(); }
+
+    inline virtual bool has_key(const key_type& key) const override
+    {
+      return map_.find(key) != map_.cend();
+    }
+
+    inline virtual bool touch_key(const key_type& key) const override
+    {
+      // pass the touch on to the chained policy
+      if (!ChainedCachingPolicy::touch_key(key))
+        return false;
+
+      // check if we have the key cached
+      auto it = map_.find(key);
+      if (it == map_.cend())
+        return false;
+
+      slots_[it->second].access(clock_);
+
+      return true;
+    }
+
+    template<typename... Args>
+    inline void insert_key(std::vector<key_type>& expired_keys, const key_type& key, Args&&... args)
+    {
+      // insert the key into the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::insert_key(expired_keys, key, std::forward<Args>(args)...);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      ++clock_;
+
+      // if we already have the key it only has to be accessed
+      auto it = map_.find(key);
+      if (it != map_.cend())
+      {
+        slots_[it->second].access(clock_);
+        return;
+      }
+
+      // check if we need to expire a key as well
+      if (is_full())
+        evict_key(expired_keys);
+
+      // append the new key
+      map_.insert(std::make_pair(key, slots_.size()));
+      slots_.emplace_back(key, clock_);
+    }
+
+    inline virtual bool erase_key(const key_type& key) override
+    {
+      auto it = map_.find(key);
+      if (it == map_.cend())
+        return false;
+
+      ChainedCachingPolicy::erase_key(key);
+      erase_at(it->second);
+
+      return true;
+    }
+
+    inline virtual void clear_keys() override
+    {
+      ChainedCachingPolicy::clear_keys();
+
+      map_.clear();
+      slots_.clear();
+      pool_.clear();
+    }
+
+    virtual void expire_keys(std::vector<key_type>& expired_keys) const override
+    {
+      // expire on the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::expire_keys(expired_keys);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      // nothing else to do because we expire on insert
+    }
+
+    // changes the maximum size of a policy with a dynamic size. the keys
+    // exceeding the new maximum size have to be removed using evict_key()
+    inline void set_max_size(size_type max_size)
+    {
+      static_assert(MaxSize == dynamic, "only a caching policy with a dynamic size can be resized");
+
+      max_size_value::set_value(max_size);
+    }
+
+    // expires the least recently used of the sampled keys
+    bool evict_key(std::vector<key_type>& expired_keys)
+    {
+      if (slots_.empty())
+        return false;
+
+      // small caches are looked at completely
+      if (slots_.size() <= Samples)
+      {
+        for (size_type index = 0; index < slots_.size(); ++index)
+          add_candidate(index);
+      }
+      else
+      {
+        std::uniform_int_distribution<size_type> dist(0, slots_.size() - 1);
+        for (size_type sample = 0; sample < Samples; ++sample)
+          add_candidate(dist(rand_));
+      }
+
+      // the candidates are ordered from the most to the least recently used
+      // but may have been accessed, erased or evicted in the meantime
+      while (true)
+      {
+        const candidate oldest = pool_.back();
+        pool_.pop_back();
+
+        auto it = map_.find(oldest.key_);
+        if (it == map_.end())
+          continue;
+
+        // put the candidate back in order if it has been accessed since
+        const uint32_t accessed = slots_[it->second].accessed();
+        if (accessed != oldest.accessed_ && !pool_.empty())
+        {
+          add_candidate(it->second);
+          continue;
+        }
+
+        const key_type key = oldest.key_;
+        expired_keys.push_back(key);
+
+        ChainedCachingPolicy::erase_key(key);
+        erase_at(it->second);
+
+        return true;
+      }
+    }
+
+  private:
+    using max_size_value = policy::dynamic_value<MaxSize, ChainedCachingPolicy>;
+
+    // number of candidates kept between evictions
+    static constexpr size_type pool_size = 16;
+
+    struct slot
+    {
+      slot(const key_type& key, uint32_t accessed)
+        : key_(key)
+        , accessed_(accessed)
+      { }
+
+      // the access time is only ever read and written concurrently while the
+      // slots aren't moved so copying doesn't need to be atomic
+      slot(const slot& other)
+        : key_(other.key_)
+        , accessed_(other.accessed())
+      { }
+
+      slot& operator=(const slot& other)
+      {
+        key_ = other.key_;
+        accessed_.store(other.accessed(), std::memory_order_relaxed);
+
+        return *this;
+      }
+
+      inline uint32_t accessed() const { return accessed_.load(std::memory_order_relaxed); }
+
+      inline void access(uint32_t time)
+      {
+        // avoid writing to the cache line of a key which has already been accessed
+        if (accessed() != time)
+          accessed_.store(time, std::memory_order_relaxed);
+      }
+
+      key_type key_;
+      std::atomic<uint32_t> accessed_;
+    };
+
+    struct candidate
+    {
+      key_type key_;
+      uint32_t accessed_;
+    };
+
+    using map = std::unordered_map<key_type, size_type>;
+
+    inline bool is_full() const
+    {
+      return slots_.size() >= max_size();
+    }
+
+    // the age is based on the difference so the clock may wrap around
+    inline uint32_t age(uint32_t accessed) const
+    {
+      return clock_ - accessed;
+    }
+
+    // adds the key at the given index to the eviction pool ordered by age
+    void add_candidate(size_type index)
+    {
+      const slot& sampled = slots_[index];
+      const uint32_t accessed = sampled.accessed();
+
+      for (auto it = pool_.begin(); it != pool_.end(); ++it)
+      {
+        if (it->key_ == sampled.key_)
+        {
+          pool_.erase(it);
+          break;
+        }
+      }
+
+      // the pool is full of older candidates
+      if (pool_.size() >= pool_size && age(accessed) <= age(pool_.front().accessed_))
+        return;
+
+      auto position = std::upper_bound(pool_.begin(), pool_.end(), age(accessed),
+        [this](uint32_t candidate_age, const candidate& other) { return candidate_age < age(other.accessed_); });
+      pool_.insert(position, candidate { sampled.key_, accessed });
+
+      if (pool_.size() > pool_size)
+        pool_.erase(pool_.begin());
+    }
+
+    // removes the key at the given index by moving the last key into its place
+    inline void erase_at(size_type index) const
+    {
+      map_.erase(slots_[index].key_);
+
+      if (index != slots_.size() - 1)
+      {
+        slots_[index] = slots_.back();
+        map_[slots_[index].key_] = index;
+      }
+
+      slots_.pop_back();
+    }
+
+    void erase_keys(const std::vector<key_type>& keys, size_type first_key) const
+    {
+      for (size_type index = first_key; index < keys.size(); ++index)
+      {
+        const key_type& key = keys[index];
+        auto it = map_.find(key);
+        if (it == map_.cend())
+          continue;
+
+        erase_at(it->second);
+      }
+    }
+
+    mutable std::vector<slot> slots_;
+    mutable map map_;
+    std::vector<candidate> pool_;
+    uint32_t clock_;
+    std::mt19937 rand_;
+  };
+}
+}
+
+#endif  // CPP_CACHE_POLICY_SAMPLED_LRU_H_
@@ -0,0 +1,255 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ */
+
+#ifndef CPP_CACHE_POLICY_SIEVE_H_
+#define CPP_CACHE_POLICY_SIEVE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <list>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "dynamic.h"
+#include "none.h"
+
+namespace cpp_cache
+{
+namespace policy
+{
+  // SIEVE keeps the keys in a first in first out queue and marks them as
+  // visited when they are touched. on eviction a hand moves from the oldest
+  // towards the newest key, clearing the visited marks on its way, and evicts
+  // the first key which hasn't been visited. visited keys stay in place
+  // instead of being moved to the front of the queue.
+  template<class Key, size_t MaxSize, class ChainedCachingPolicy = none<Key, size_t>>
+  class sieve : public ChainedCachingPolicy, private dynamic_value<MaxSize, ChainedCachingPolicy>
+  {
+  public:
+    using key_type = Key;
+    using size_type = size_t;
+
+    // touching a key only sets an atomic visited mark
+    static constexpr bool shared_reads = cpp_cache::detail::shared_reads<ChainedCachingPolicy>::value;
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size != dynamic, int>::type = 0>
+    explicit sieve(ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(MaxSize)
+      , queue_()
+      , map_()
+      , hand_(queue_.end())
+    {
+      map_.reserve(MaxSize);
+    }
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size == dynamic, int>::type = 0>
+    explicit sieve(size_type max_size, ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(max_size)
+      , queue_()
+      , map_()
+      , hand_(queue_.end())
+    {
+      map_.reserve(max_size);
+    }
+
+    virtual ~sieve()
+    {
+      clear_keys();
+    }
+
+    inline size_type max_size() const { return max_size_value::value(); }
+
+  protected:
+    inline virtual size_type size() const override { return map_.size(); }
+
+    inline virtual bool empty() const override { return map_.empty(); }
+
+    inline virtual bool has_key(const key_type& key) const override
+    {
+      return map_.find(key) != map_.cend();
+    }
+
+    inline virtual bool touch_key(const key_type& key) const override
+    {
+      // pass the touch on to the chained policy
+      if (!ChainedCachingPolicy::touch_key(key))
+        return false;
+
+      // check if we have the key cached
+      auto it = map_.find(key);
+      if (it == map_.cend())
+        return false;
+
+      it->second->visit();
+
+      return true;
+    }
+
+    template<typename... Args>
+    inline void insert_key(std::vector<key_type>& expired_keys, const key_type& key, Args&&... args)
+    {
+      // insert the key into the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::insert_key(expired_keys, key, std::forward<Args>(args)...);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      // if we already have the key it only has to be marked as visited
+      auto it = map_.find(key);
+      if (it != map_.cend())
+      {
+        it->second->visit();
+        return;
+      }
+
+      // check if we need to expire a key as well
+      if (is_full())
+        evict_key(expired_keys);
+
+      // insert the new key at the beginning
+      queue_.emplace_front(key);
+      map_[key] = queue_.begin();
+    }
+
+    inline virtual bool erase_key(const key_type& key) override
+    {
+      auto it = map_.find(key);
+      if (it == map_.cend())
+        return false;
+
+      ChainedCachingPolicy::erase_key(key);
+
+      erase_entry(it);
+
+      return true;
+    }
+
+    inline virtual void clear_keys() override
+    {
+      ChainedCachingPolicy::clear_keys();
+
+      map_.clear();
+      queue_.clear();
+      hand_ = queue_.end();
+    }
+
+    virtual void expire_keys(std::vector<key_type>& expired_keys) const override
+    {
+      // expire on the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::expire_keys(expired_keys);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      // nothing else to do because we expire on insert
+    }
+
+    // changes the maximum size of a policy with a dynamic size. the keys
+    // exceeding the new maximum size have to be removed using evict_key()
+    inline void set_max_size(size_type max_size)
+    {
+      static_assert(MaxSize == dynamic, "only a caching policy with a dynamic size can be resized");
+
+      max_size_value::set_value(max_size);
+    }
+
+    // expires the first key under the hand which hasn't been visited since the
+    // hand last passed it
+    bool evict_key(std::vector<key_type>& expired_keys)
+    {
+      if (queue_.empty())
+        return false;
+
+      // the hand starts at the oldest key and wraps around to it
+      queue_iterator victim = hand_ == queue_.end() ? std::prev(queue_.end()) : hand_;
+      while (victim->clear_visited())
+        victim = victim == queue_.begin() ? std::prev(queue_.end()) : std::prev(victim);
+
+      const key_type key = victim->key_;
+      ChainedCachingPolicy::erase_key(key);
+
+      // erasing the victim moves the hand on to the next newer key
+      hand_ = victim;
+      erase_entry(map_.find(key));
+
+      expired_keys.push_back(key);
+
+      return true;
+    }
+
+  private:
+    using max_size_value = policy::dynamic_value<MaxSize, ChainedCachingPolicy>;
+
+    struct entry
+    {
+      explicit entry(const key_type& key)
+        : key_(key)
+        , visited_(false)
+      { }
+
+      inline void visit()
+      {
+        // avoid writing to the cache line of a key which is already visited
+        if (!visited_.load(std::memory_order_relaxed))
+          visited_.store(true, std::memory_order_relaxed);
+      }
+
+      // returns whether the key had been visited
+      inline bool clear_visited()
+      {
+        return visited_.exchange(false, std::memory_order_relaxed);
+      }
+
+      key_type key_;
+      std::atomic<bool> visited_;
+    };
+
+    using queue = std::list<entry>;
+    using queue_iterator = typename queue::iterator;
+    using map = std::unordered_map<key_type, queue_iterator>;
+    using map_iterator = typename map::iterator;
+
+    inline bool is_full() const
+    {
+      return map_.size() >= max_size();
+    }
+
+    inline void erase_entry(map_iterator it) const
+    {
+      // the hand moves on to the next newer key
+      if (it->second == hand_)
+        hand_ = hand_ == queue_.begin() ? queue_.end() : std::prev(hand_);
+
+      queue_.erase(it->second);
+      map_.erase(it);
+    }
+
+    void erase_keys(const std::vector<key_type>& keys, size_type first_key) const
+    {
+      for (size_type index = first_key; index < keys.size(); ++index)
+      {
+        const key_type& key = keys[index];
+        auto it = map_.find(key);
+        if (it == map_.end())
+          continue;
+
+        erase_entry(it);
+      }
+    }
+
+    mutable queue queue_;
+    mutable map map_;
+    mutable queue_iterator hand_;
+  };
+}
+}
+
+#endif  // CPP_CACHE_POLICY_SIEVE_H_
@@ -0,0 +1,251 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ */
+
+#ifndef CPP_CACHE_POLICY_SLRU_H_
+#define CPP_CACHE_POLICY_SLRU_H_
+
+#include <cstddef>
+#include <iterator>
+#include <list>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "dynamic.h"
+#include "none.h"
+
+namespace cpp_cache
+{
+namespace policy
+{
+  // segmented least recently used policy. new keys are inserted into the
+  // probationary segment and only keys touched there are promoted to the
+  // protected segment which holds ProtectedPercent of the maximum size. keys
+  // falling out of the protected segment are demoted back into the
+  // probationary segment and keys are only ever evicted from there unless it
+  // is empty. keys only used once (e.g. by a scan) therefore never evict the
+  // protected keys.
+  template<class Key, size_t MaxSize, size_t ProtectedPercent = 80, class ChainedCachingPolicy = none<Key, size_t>>
+  class slru : public ChainedCachingPolicy, private dynamic_value<MaxSize, ChainedCachingPolicy>
+  {
+  public:
+    using key_type = Key;
+    using size_type = size_t;
+
+    static_assert(ProtectedPercent <= 100, "the protected segment can't be larger than the cache");
+
+    // touching a key moves it to the front of the protected segment
+    static constexpr bool shared_reads = false;
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size != dynamic, int>::type = 0>
+    explicit slru(ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(MaxSize)
+      , probationary_()
+      , protected_()
+      , map_()
+    {
+      map_.reserve(MaxSize);
+    }
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size == dynamic, int>::type = 0>
+    explicit slru(size_type max_size, ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(max_size)
+      , probationary_()
+      , protected_()
+      , map_()
+    {
+      map_.reserve(max_size);
+    }
+
+    virtual ~slru()
+    {
+      clear_keys();
+    }
+
+    inline size_type max_size() const { return max_size_value::value(); }
+
+    inline size_type protected_size() const { return max_size() * ProtectedPercent / 100; }
+
+  protected:
+    inline virtual size_type size() const override { return map_.size(); }
+
+    inline virtual bool empty() const override { return map_.empty(); }
+
+    inline virtual bool has_key(const key_type& key) const override
+    {
+      return map_.find(key) != map_.cend();
+    }
+
+    inline virtual bool touch_key(const key_type& key) const override
+    {
+      // pass the touch on to the chained policy
+      if (!ChainedCachingPolicy::touch_key(key))
+        return false;
+
+      // check if we have the key cached
+      auto it = map_.find(key);
+      if (it == map_.cend())
+        return false;
+
+      promote(it->second);
+
+      return true;
+    }
+
+    template<typename... Args>
+    inline void insert_key(std::vector<key_type>& expired_keys, const key_type& key, Args&&... args)
+    {
+      // insert the key into the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::insert_key(expired_keys, key, std::forward<Args>(args)...);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      // if we already have the key it counts as a touch
+      auto it = map_.find(key);
+      if (it != map_.cend())
+      {
+        promote(it->second);
+        return;
+      }
+
+      // check if we need to expire a key as well
+      if (is_full())
+        evict_key(expired_keys);
+
+      // new keys are on probation
+      probationary_.push_front(key);
+      map_[key] = entry { probationary_.begin(), false };
+    }
+
+    inline virtual bool erase_key(const key_type& key) override
+    {
+      auto it = map_.find(key);
+      if (it == map_.cend())
+        return false;
+
+      ChainedCachingPolicy::erase_key(key);
+
+      erase_entry(it);
+
+      return true;
+    }
+
+    inline virtual void clear_keys() override
+    {
+      ChainedCachingPolicy::clear_keys();
+
+      map_.clear();
+      probationary_.clear();
+      protected_.clear();
+    }
+
+    virtual void expire_keys(std::vector<key_type>& expired_keys) const override
+    {
+      // expire on the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::expire_keys(expired_keys);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      // nothing else to do because we expire on insert
+    }
+
+    // changes the maximum size of a policy with a dynamic size. the keys
+    // exceeding the new maximum size have to be removed using evict_key()
+    inline void set_max_size(size_type max_size)
+    {
+      static_assert(MaxSize == dynamic, "only a caching policy with a dynamic size can be resized");
+
+      max_size_value::set_value(max_size);
+    }
+
+    // expires the least recently used key of the probationary segment or of
+    // the protected segment if the probationary segment is empty
+    bool evict_key(std::vector<key_type>& expired_keys)
+    {
+      if (map_.empty())
+        return false;
+
+      const key_type last_key = probationary_.empty() ? protected_.back() : probationary_.back();
+      ChainedCachingPolicy::erase_key(last_key);
+
+      erase_entry(map_.find(last_key));
+
+      expired_keys.push_back(last_key);
+
+      return true;
+    }
+
+  private:
+    using max_size_value = policy::dynamic_value<MaxSize, ChainedCachingPolicy>;
+
+    using list = std::list<key_type>;
+    using list_iterator = typename list::iterator;
+
+    struct entry
+    {
+      list_iterator position_;
+      bool in_protected_;
+    };
+
+    using map = std::unordered_map<key_type, entry>;
+    using map_iterator = typename map::iterator;
+
+    inline bool is_full() const
+    {
+      return map_.size() >= max_size();
+    }
+
+    // moves the key to the front of the protected segment and demotes the
+    // least recently used protected keys which don't fit anymore
+    void promote(entry& key_entry) const
+    {
+      protected_.splice(protected_.begin(), key_entry.in_protected_ ? protected_ : probationary_, key_entry.position_);
+      key_entry.in_protected_ = true;
+
+      while (protected_.size() > protected_size())
+      {
+        entry& last_entry = map_.find(protected_.back())->second;
+        probationary_.splice(probationary_.begin(), protected_, std::prev(protected_.end()));
+        last_entry.in_protected_ = false;
+      }
+    }
+
+    inline void erase_entry(map_iterator it) const
+    {
+      if (it->second.in_protected_)
+        protected_.erase(it->second.position_);
+      else
+        probationary_.erase(it->second.position_);
+
+      map_.erase(it);
+    }
+
+    void erase_keys(const std::vector<key_type>& keys, size_type first_key) const
+    {
+      for (size_type index = first_key; index < keys.size(); ++index)
+      {
+        const key_type& key = keys[index];
+        auto it = map_.find(key);
+        if (it == map_.end())
+          continue;
+
+        erase_entry(it);
+      }
+    }
+
+    mutable list probationary_;
+    mutable list protected_;
+    mutable map map_;
+  };
+}
+}
+
+#endif  // CPP_CACHE_POLICY_SLRU_H_
@@ -0,0 +1,472 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ */
+
+#ifndef CPP_CACHE_POLICY_TINYLFU_H_
+#define CPP_CACHE_POLICY_TINYLFU_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "dynamic.h"
+#include "none.h"
+
+namespace cpp_cache
+{
+namespace policy
+{
+namespace detail
+{
+  // count-min sketch with four rows of 4-bit counters used to estimate how
+  // often a key has been accessed. all counters are halved once the number of
+  // increments reaches ten times the capacity so that old accesses age out.
+  template<class Key, class Hash = std::hash<Key>>
+  class frequency_sketch
+  {
+  public:
+    using key_type = Key;
+    using frequency_type = size_t;
+
+    explicit frequency_sketch(size_t capacity)
+      : table_(table_size(capacity), 0)
+      , mask_(table_.size() - 1)
+      , sample_size_(10 * std::max<size_t>(capacity, 1))
+      , additions_(0)
+      , hash_()
+    { }
+
+    frequency_type frequency(const key_type& key) const
+    {
+      return static_cast<frequency_type>(estimate(spread(hash_(key))));
+    }
+
+    void increment(const key_type& key)
+    {
+      const uint64_t hash = spread(hash_(key));
+
+      // conservative update: only increment the counters holding the current
+      // estimate to reduce the overestimation caused by collisions
+      const uint64_t current = estimate(hash);
+      if (current == max_count)
+        return;
+
+      for (size_t row = 0; row < rows; ++row)
+      {
+        size_t index;
+        size_t offset;
+        position(hash, row, index, offset);
+
+        if (((table_[index] >> offset) & max_count) == current)
+          table_[index] += UINT64_C(1) << offset;
+      }
+
+      if (++additions_ >= sample_size_)
+        reset();
+    }
+
+    void clear()
+    {
+      std::fill(table_.begin(), table_.end(), 0);
+      additions_ = 0;
+    }
+
+  private:
+    static constexpr size_t rows = 4;
+    static constexpr uint64_t max_count = 15;
+
+    static size_t table_size(size_t capacity)
+    {
+      // every entry holds sixteen counters, use a power of two for cheap indexing
+      size_t size = 1;
+      while (size < capacity)
+        size <<= 1;
+
+      return size;
+    }
+
+    static inline uint64_t spread(uint64_t hash)
+    {
+      hash ^= hash >> 33;
+      hash *= UINT64_C(0xff51afd7ed558ccd);
+      hash ^= hash >> 33;
+      hash *= UINT64_C(0xc4ceb9fe1a85ec53);
+      hash ^= hash >> 33;
+
+      return hash;
+    }
+
+    inline void position(uint64_t hash, size_t row, size_t& index, size_t& offset) const
+    {
+      static const uint64_t seeds[rows] = {
+        UINT64_C(0x97cb3127e1f0b3d5), UINT64_C(0xb492b66fbe98f273),
+        UINT64_C(0x9ae16a3b2f90404f), UINT64_C(0xcbf29ce484222325)
+      };
+
+      uint64_t row_hash = (hash + seeds[row]) * seeds[row];
+      row_hash ^= row_hash >> 32;
+
+      index = static_cast<size_t>(row_hash) & mask_;
+      offset = static_cast<size_t>((row_hash >> 40) & 15) << 2;
+    }
+
+    inline uint64_t estimate(uint64_t hash) const
+    {
+      uint64_t estimate = max_count;
+      for (size_t row = 0; row < rows; ++row)
+      {
+        size_t index;
+        size_t offset;
+        position(hash, row, index, offset);
+
+        estimate = std::min(estimate, (table_[index] >> offset) & max_count);
+      }
+
+      return estimate;
+    }
+
+    void reset()
+    {
+      // halve all counters at once
+      for (auto& entry : table_)
+        entry = (entry >> 1) & UINT64_C(0x7777777777777777);
+
+      additions_ /= 2;
+    }
+
+    std::vector<uint64_t> table_;
+    size_t mask_;
+    size_t sample_size_;
+    size_t additions_;
+    Hash hash_;
+  };
+}
+
+  // window tiny least frequently used: new keys enter a small LRU window and
+  // have to compete against the victim of a segmented LRU main region once
+  // they leave the window. the key with the higher estimated frequency stays.
+  template<class Key, size_t MaxSize, class ChainedCachingPolicy = none<Key, size_t>>
+  class tinylfu : public ChainedCachingPolicy, private dynamic_value<MaxSize, ChainedCachingPolicy>
+  {
+  public:
+    using key_type = Key;
+    using size_type = size_t;
+
+    // touching a key records it in the frequency sketch
+    static constexpr bool shared_reads = false;
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size != dynamic, int>::type = 0>
+    explicit tinylfu(ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(MaxSize)
+      , window_()
+      , probation_()
+      , protected_()
+      , map_()
+      , sketch_(MaxSize)
+    {
+      map_.reserve(MaxSize);
+    }
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size == dynamic, int>::type = 0>
+    explicit tinylfu(size_type max_size, ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(max_size)
+      , window_()
+      , probation_()
+      , protected_()
+      , map_()
+      , sketch_(max_size)
+    {
+      map_.reserve(max_size);
+    }
+
+    virtual ~tinylfu()
+    {
+      clear_keys();
+    }
+
+    inline size_type max_size() const { return max_size_value::value(); }
+
+  protected:
+    inline virtual size_type size() const override { return map_.size(); }
+
+    inline virtual bool empty() const override { return map_.empty(); }
+
+    inline virtual bool has_key(const key_type& key) const override
+    {
+      return map_.find(key) != map_.cend();
+    }
+
+    inline virtual bool touch_key(const key_type& key) const override
+    {
+      // pass the touch on to the chained policy
+      if (!ChainedCachingPolicy::touch_key(key))
+        return false;
+
+      // check if we have the key cached
+      auto it = map_.find(key);
+      if (it == map_.cend())
+        return false;
+
+      sketch_.increment(key);
+      touch_entry(it->second);
+
+      return true;
+    }
+
+    template<typename... Args>
+    inline void insert_key(std::vector<key_type>& expired_keys, const key_type& key, Args&&... args)
+    {
+      // insert the key into the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::insert_key(expired_keys, key, std::forward<Args>(args)...);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      sketch_.increment(key);
+
+      // if we already have the key inserting it again counts as another use
+      auto it = map_.find(key);
+      if (it != map_.cend())
+      {
+        touch_entry(it->second);
+        return;
+      }
+
+      // new keys always enter the window
+      window_.push_front(key);
+      map_.insert(std::make_pair(key, entry { segment::window, window_.begin() }));
+
+      // move the least recently used key out of the window if it is full
+      while (window_.size() > window_max_size())
+        evict_from_window(expired_keys);
+    }
+
+    inline virtual bool erase_key(const key_type& key) override
+    {
+      auto it = map_.find(key);
+      if (it == map_.cend())
+        return false;
+
+      ChainedCachingPolicy::erase_key(key);
+
+      erase_entry(it);
+
+      return true;
+    }
+
+    inline virtual void clear_keys() override
+    {
+      ChainedCachingPolicy::clear_keys();
+
+      map_.clear();
+      window_.clear();
+      probation_.clear();
+      protected_.clear();
+      sketch_.clear();
+    }
+
+    virtual void expire_keys(std::vector<key_type>& expired_keys) const override
+    {
+      // expire on the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::expire_keys(expired_keys);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      // nothing else to do because we expire on insert
+    }
+
+    // changes the maximum size of a policy with a dynamic size. the keys
+    // exceeding the new maximum size have to be removed using evict_key(). the
+    // frequency sketch keeps the size it was created with.
+    inline void set_max_size(size_type max_size)
+    {
+      static_assert(MaxSize == dynamic, "only a caching policy with a dynamic size can be resized");
+
+      max_size_value::set_value(max_size);
+    }
+
+    // expires the victim of the main region or the least recently used key of
+    // the window if the main region is empty
+    bool evict_key(std::vector<key_type>& expired_keys)
+    {
+      if (!probation_.empty())
+        evict(map_.find(probation_.back()), expired_keys);
+      else if (!protected_.empty())
+        evict(map_.find(protected_.back()), expired_keys);
+      else if (!window_.empty())
+        evict(map_.find(window_.back()), expired_keys);
+      else
+        return false;
+
+      return true;
+    }
+
+  private:
+    using max_size_value = policy::dynamic_value<MaxSize, ChainedCachingPolicy>;
+
+    using list = std::list<key_type>;
+    using list_iterator = typename list::iterator;
+
+    enum class segment
+    {
+      window,
+      probation,
+      protection
+    };
+
+    struct entry
+    {
+      segment location;
+      list_iterator position;
+    };
+
+    using map = std::unordered_map<key_type, entry>;
+    using map_iterator = typename map::iterator;
+
+    inline size_type window_max_size() const
+    {
+      // the window holds about one percent of the keys
+      return std::max<size_type>(max_size() / 100, 1);
+    }
+
+    inline size_type main_max_size() const
+    {
+      return max_size() > window_max_size() ? max_size() - window_max_size() : 0;
+    }
+
+    inline size_type protected_max_size() const
+    {
+      // the protected segment holds about 80 percent of the main region
+      return main_max_size() * 4 / 5;
+    }
+
+    inline list& segment_list(segment location) const
+    {
+      switch (location)
+      {
+      case segment::probation:
+        return probation_;
+
+      case segment::protection:
+        return protected_;
+
+      case segment::window:
+      default:
+        return window_;
+      }
+    }
+
+    void touch_entry(entry& key_entry) const
+    {
+      switch (key_entry.location)
+      {
+      case segment::window:
+      case segment::protection:
+      {
+        // move the key to the front of its segment
+        list& keys = segment_list(key_entry.location);
+        keys.splice(keys.begin(), keys, key_entry.position);
+        break;
+      }
+
+      case segment::probation:
+        // a key used again in probation is promoted to the protected segment
+        protected_.splice(protected_.begin(), probation_, key_entry.position);
+        key_entry.location = segment::protection;
+
+        // demote the least recently used keys of the protected segment if necessary
+        while (protected_.size() > protected_max_size())
+        {
+          auto demoted_it = std::prev(protected_.end());
+          probation_.splice(probation_.begin(), protected_, demoted_it);
+          map_.at(*demoted_it).location = segment::probation;
+        }
+        break;
+      }
+    }
+
+    void evict_from_window(std::vector<key_type>& expired_keys)
+    {
+      auto candidate_it = std::prev(window_.end());
+      const size_type main_size = probation_.size() + protected_.size();
+
+      // as long as the main region isn't full the candidate is simply admitted
+      if (main_size < main_max_size())
+      {
+        admit(candidate_it);
+        return;
+      }
+
+      // without any main region the candidate has to be expired
+      if (main_size == 0)
+      {
+        evict(map_.find(*candidate_it), expired_keys);
+        return;
+      }
+
+      // the candidate competes against the least recently used key of the main region
+      const auto victim_it = probation_.empty() ? std::prev(protected_.end()) : std::prev(probation_.end());
+      if (sketch_.frequency(*candidate_it) > sketch_.frequency(*victim_it))
+      {
+        evict(map_.find(*victim_it), expired_keys);
+        admit(candidate_it);
+      }
+      else
+        evict(map_.find(*candidate_it), expired_keys);
+    }
+
+    inline void admit(list_iterator candidate_it)
+    {
+      probation_.splice(probation_.begin(), window_, candidate_it);
+      map_.at(*candidate_it).location = segment::probation;
+    }
+
+    inline void evict(map_iterator it, std::vector<key_type>& expired_keys)
+    {
+      expired_keys.push_back(it->first);
+      ChainedCachingPolicy::erase_key(it->first);
+
+      erase_entry(it);
+    }
+
+    inline void erase_entry(map_iterator it) const
+    {
+      segment_list(it->second.location).erase(it->second.position);
+      map_.erase(it);
+    }
+
+    void erase_keys(const std::vector<key_type>& keys, size_type first_key) const
+    {
+      for (size_type index = first_key; index < keys.size(); ++index)
+      {
+        const key_type& key = keys[index];
+        auto it = map_.find(key);
+        if (it == map_.end())
+          continue;
+
+        erase_entry(it);
+      }
+    }
+
+    mutable list window_;
+    mutable list probation_;
+    mutable list protected_;
+    mutable map map_;
+    mutable detail::frequency_sketch<key_type> sketch_;
+  };
+}
+}
+
+#endif  // CPP_CACHE_POLICY_TINYLFU_H_
@@ -6,30 +6,54 @@
 #define CPP_CACHE_POLICY_TTL_H_
 
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <list>
 #include <ratio>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "dynamic.h"
 #include "none.h"
 
 namespace cpp_cache
 {
 namespace policy
 {
-  template<class Key, size_t MaxAgeMs, class ChainedCachingPolicy = none<Key, size_t>>
-  class ttl : public ChainedCachingPolicy
+  // the clock providing the current time can be replaced (e.g. by a manually
+  // advanced clock in tests)
+  template<class Key, size_t MaxAgeMs, class ChainedCachingPolicy = none<Key, size_t>, class Clock = std::chrono::system_clock>
+  class ttl : public ChainedCachingPolicy, private dynamic_value<MaxAgeMs, ChainedCachingPolicy>
   {
   private:
-    using time = std::chrono::time_point<std::chrono::system_clock>;
+    using time = std::chrono::time_point<Clock>;
     using duration = std::chrono::milliseconds;
+    using tick_type = uint64_t;
+
+    // the keys are scheduled in a hierarchical timing wheel with a resolution
+    // of one millisecond. every level has 64 slots each covering 64 times the
+    // duration of a slot of the level below.
+    static constexpr size_t wheel_bits = 6;
+    static constexpr size_t wheel_size = 1 << wheel_bits;
+    static constexpr size_t wheel_mask = wheel_size - 1;
+    static constexpr size_t wheel_levels = 4;
+
+    using slot = std::list<Key>;
+    using slot_iterator = typename slot::iterator;
+    using wheel = std::array<slot, wheel_size>;
+
     struct ttl_key
     {
       time start_;
       duration duration_;
       time end_;
+      size_t level_;
+      size_t slot_;
+      slot_iterator position_;
     };
 
   public:
@@ -38,8 +62,29 @@ namespace policy
     using duration_type = duration;
     using size_type = size_t;
 
-    ttl()
-      : map_()
+    // touching a key extends its time-to-live and keys expire on their own
+    static constexpr bool shared_reads = false;
+
+    template<typename... ChainedArgs, size_t Age = MaxAgeMs, typename std::enable_if<Age != dynamic, int>::type = 0>
+    explicit ttl(ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_age_value(MaxAgeMs)
+      , map_()
+      , wheels_()
+      , level_sizes_()
+      , epoch_(time::clock::now())
+      , current_tick_(0)
+    { }
+
+    template<typename... ChainedArgs, size_t Age = MaxAgeMs, typename std::enable_if<Age == dynamic, int>::type = 0>
+    explicit ttl(age_type default_max_age, ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_age_value(default_max_age)
+      , map_()
+      , wheels_()
+      , level_sizes_()
+      , epoch_(time::clock::now())
+      , current_tick_(0)
     { }
 
     virtual ~ttl()
@@ -47,9 +92,18 @@ namespace policy
       clear_keys();
     }
 
-    inline virtual age_type default_max_age() const { return MaxAgeMs; }
+    inline age_type default_max_age() const { return max_age_value::value(); }
 
   protected:
+    // changes the maximum age of keys inserted without a maximum age of their
+    // own into a policy with a dynamic default maximum age
+    inline void set_default_max_age(age_type max_age_ms)
+    {
+      static_assert(MaxAgeMs == dynamic, "only a caching policy with a dynamic default maximum age can change it");
+
+      max_age_value::set_value(max_age_ms);
+    }
+
     inline virtual size_type size() const override { return map_.size(); }
 
     inline virtual bool empty() const override { return map_.empty(); }
@@ -72,23 +126,23 @@ namespace policy
 
       // update the end time of the key because it was just used
       it->second.end_ = time::clock::now() + it->second.duration_;
+      reschedule(it->second);
 
       return true;
     }
 
     template<typename... Args>
-    inline std::vector<key_type> insert_key(const key_type& key, Args&&... args)
+    inline void insert_key(std::vector<key_type>& expired_keys, const key_type& key, Args&&... args)
     {
       // insert the key into the chained policy
-      auto expired_keys = ChainedCachingPolicy::insert_key(key, std::forward<Args>(args)...);
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::insert_key(expired_keys, key, std::forward<Args>(args)...);
 
       // remove all the keys that were expired in the chained policy
-      erase_keys(expired_keys);
+      erase_keys(expired_keys, first_expired_key);
 
       // pass the call to the proper internal handler relying on SFINAE
       insert_key_internal(key, std::forward<Args>(args)...);
-
-      return expired_keys;
     }
 
     inline virtual bool erase_key(const key_type& key) override
@@ -98,7 +152,7 @@ namespace policy
         return false;
 
       ChainedCachingPolicy::erase_key(key);
-      map_.erase(it);
+      erase_entry(it);
 
       return true;
     }
@@ -107,36 +161,67 @@ namespace policy
     {
       ChainedCachingPolicy::clear_keys();
       map_.clear();
+
+      for (auto& level : wheels_)
+      {
+        for (auto& keys : level)
+          keys.clear();
+      }
+      level_sizes_.fill(0);
     }
 
-    virtual std::vector<key_type> expire_keys() const override
+    virtual void expire_keys(std::vector<key_type>& expired_keys) const override
     {
       // expire on the chained policy
-      std::vector<key_type> expired_keys = ChainedCachingPolicy::expire_keys();
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::expire_keys(expired_keys);
 
       // remove all the keys that were expired in the chained policy
-      erase_keys(expired_keys);
+      erase_keys(expired_keys, first_expired_key);
 
-      // get the current time
-      time now = time::clock::now();
+      // advance the timing wheel up to the current time and expire all keys
+      // that have exceeded their time-to-live on the way
+      advance(time::clock::now(), expired_keys);
+    }
 
-      // find and remove all keys that have expired their time-to-live
-      for (auto it = map_.cbegin(); it != map_.cend(); )
+    // expires one of the keys which are closest to exceeding their time-to-live
+    bool evict_key(std::vector<key_type>& expired_keys)
+    {
+      // the lower levels of the timing wheel hold the keys expiring sooner
+      for (size_t level = 0; level < wheel_levels; ++level)
       {
-        if (it->second.end_ < now)
+        if (level_sizes_[level] == 0)
+          continue;
+
+        // start with the slot which will be processed next. on the higher
+        // levels the current slot has already been cascaded so it can only
+        // hold keys which wrapped around and is visited last.
+        const size_t current_slot = static_cast<size_t>((current_tick_ >> (wheel_bits * level)) & wheel_mask);
+        const size_t first_slot = level == 0 ? current_slot : current_slot + 1;
+        for (size_t offset = 0; offset < wheel_size; ++offset)
         {
-          expired_keys.push_back(it->first);
-          map_.erase(it++);
+          slot& keys = wheels_[level][(first_slot + offset) & wheel_mask];
+          if (keys.empty())
+            continue;
+
+          const key_type key = keys.front();
+          ChainedCachingPolicy::erase_key(key);
+          erase_entry(map_.find(key));
+
+          expired_keys.push_back(key);
+
+          return true;
         }
-        else
-          ++it;
       }
 
-      return expired_keys;
+      return false;
     }
 
   private:
+    using max_age_value = policy::dynamic_value<MaxAgeMs, ChainedCachingPolicy>;
+
     using map = std::unordered_map<key_type, ttl_key>;
+    using map_iterator = typename map::iterator;
 
     template<typename... Args>
     inline void insert_key_internal(const key_type& key, Args&&... args)
@@ -159,22 +244,145 @@ namespace policy
       auto it = map_.find(key);
       // if it doesn't exist yet insert it and determine the end time
       if (it == map_.cend())
-        map_.insert(std::make_pair(key, ttl_key { now, max_age_duration, now + max_age_duration }));
+      {
+        it = map_.insert(std::make_pair(key, ttl_key { now, max_age_duration, now + max_age_duration, 0, 0, slot_iterator() })).first;
+        schedule(it->first, it->second);
+      }
       else
       {
         // update the duration and the end time of the key because it was just used
         it->second.duration_ = max_age_duration;
         it->second.end_ = now + it->second.duration_;
+        reschedule(it->second);
+      }
+    }
+
+    inline tick_type to_tick(const time& point) const
+    {
+      const auto elapsed = std::chrono::duration_cast<duration>(point - epoch_).count();
+      return elapsed < 0 ? 0 : static_cast<tick_type>(elapsed);
+    }
+
+    inline static tick_type level_span(size_t level)
+    {
+      return static_cast<tick_type>(1) << (wheel_bits * level);
+    }
+
+    // determines the level and slot of the wheel in which the key has to be
+    // processed. a key is processed in the first tick after its end time.
+    inline void position(const ttl_key& entry, size_t& level, size_t& slot_index) const
+    {
+      tick_type expiry_tick = std::max(to_tick(entry.end_) + 1, current_tick_);
+
+      level = 0;
+      while (level < wheel_levels - 1 && expiry_tick - current_tick_ >= level_span(level + 1))
+        ++level;
+
+      // keys beyond the range of the top level are parked in its furthest slot
+      // and will be rescheduled once that slot is cascaded
+      if (expiry_tick - current_tick_ >= level_span(wheel_levels))
+        expiry_tick = current_tick_ + level_span(wheel_levels) - 1;
+
+      slot_index = static_cast<size_t>((expiry_tick >> (wheel_bits * level)) & wheel_mask);
+    }
+
+    inline void schedule(const key_type& key, ttl_key& entry) const
+    {
+      position(entry, entry.level_, entry.slot_);
+
+      slot& keys = wheels_[entry.level_][entry.slot_];
+      entry.position_ = keys.insert(keys.end(), key);
+      ++level_sizes_[entry.level_];
+    }
+
+    inline void reschedule(ttl_key& entry) const
+    {
+      size_t level;
+      size_t slot_index;
+      position(entry, level, slot_index);
+
+      // move the list node without any reallocation
+      slot& keys = wheels_[level][slot_index];
+      keys.splice(keys.end(), wheels_[entry.level_][entry.slot_], entry.position_);
+
+      --level_sizes_[entry.level_];
+      ++level_sizes_[level];
+      entry.level_ = level;
+      entry.slot_ = slot_index;
+    }
+
+    inline void erase_entry(map_iterator it) const
+    {
+      wheels_[it->second.level_][it->second.slot_].erase(it->second.position_);
+      --level_sizes_[it->second.level_];
+      map_.erase(it);
+    }
+
+    // moves all keys from the current slot of the given level to the levels below
+    void cascade(size_t level) const
+    {
+      const size_t slot_index = static_cast<size_t>((current_tick_ >> (wheel_bits * level)) & wheel_mask);
+
+      // first cascade the level above if this level has completed a full round
+      if (slot_index == 0 && level + 1 < wheel_levels)
+        cascade(level + 1);
+
+      slot& keys = wheels_[level][slot_index];
+      while (!keys.empty())
+        reschedule(map_.find(keys.front())->second);
+    }
+
+    void advance(const time& now, std::vector<key_type>& expired_keys) const
+    {
+      const tick_type target_tick = to_tick(now);
+
+      while (current_tick_ <= target_tick)
+      {
+        // nothing to expire
+        if (map_.empty())
+        {
+          current_tick_ = target_tick + 1;
+          break;
+        }
+
+        const size_t slot_index = static_cast<size_t>(current_tick_ & wheel_mask);
+        if (slot_index == 0)
+          cascade(1);
+
+        // all keys in the current slot of the lowest level have expired
+        slot& keys = wheels_[0][slot_index];
+        while (!keys.empty())
+        {
+          expired_keys.push_back(keys.front());
+          erase_entry(map_.find(keys.front()));
+        }
+
+        ++current_tick_;
+
+        // skip ahead to the next cascade if there is nothing on the lowest level
+        if (level_sizes_[0] == 0 && (current_tick_ & wheel_mask) != 0)
+          current_tick_ = std::min(target_tick + 1, (current_tick_ | wheel_mask) + 1);
       }
     }
 
-    void erase_keys(const std::vector<key_type>& keys) const
+    void erase_keys(const std::vector<key_type>& keys, size_type first_key) const
     {
-      for (const auto& key : keys)
-        map_.erase(key);
+      for (size_type index = first_key; index < keys.size(); ++index)
+      {
+        const key_type& key = keys[index];
+        auto it = map_.find(key);
+        if (it == map_.end())
+          continue;
+
+        erase_entry(it);
+      }
     }
 
     mutable map map_;
+    mutable std::array<wheel, wheel_levels> wheels_;
+    mutable std::array<size_t, wheel_levels> level_sizes_;
+    time epoch_;
+    mutable tick_type current_tick_;
   };
 }
 }
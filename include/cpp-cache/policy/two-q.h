@@ -0,0 +1,268 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ */
+
+#ifndef CPP_CACHE_POLICY_TWO_Q_H_
+#define CPP_CACHE_POLICY_TWO_Q_H_
+
+#include <cstddef>
+#include <list>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "dynamic.h"
+#include "ghost.h"
+#include "none.h"
+
+namespace cpp_cache
+{
+namespace policy
+{
+  // 2Q keeps new keys in the first in first out queue A1in (a quarter of the
+  // maximum size) where touches are ignored. keys evicted from A1in are
+  // remembered in the ghost list A1out (half of the maximum size) and only
+  // keys inserted again while they are remembered make it into the least
+  // recently used list Am. keys only used once (e.g. by a scan) therefore
+  // never evict the keys in Am.
+  template<class Key, size_t MaxSize, class ChainedCachingPolicy = none<Key, size_t>>
+  class two_q : public ChainedCachingPolicy, private dynamic_value<MaxSize, ChainedCachingPolicy>
+  {
+  public:
+    using key_type = Key;
+    using size_type = size_t;
+
+    // touching a key in Am moves it to the front of the list
+    static constexpr bool shared_reads = false;
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size != dynamic, int>::type = 0>
+    explicit two_q(ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(MaxSize)
+      , in_()
+      , main_()
+      , map_()
+      , out_()
+    {
+      map_.reserve(MaxSize);
+    }
+
+    template<typename... ChainedArgs, size_t Size = MaxSize, typename std::enable_if<Size == dynamic, int>::type = 0>
+    explicit two_q(size_type max_size, ChainedArgs&&... args)
+      : ChainedCachingPolicy(std::forward<ChainedArgs>(args)...)
+      , max_size_value(max_size)
+      , in_()
+      , main_()
+      , map_()
+      , out_()
+    {
+      map_.reserve(max_size);
+    }
+
+    virtual ~two_q()
+    {
+      clear_keys();
+    }
+
+    inline size_type max_size() const { return max_size_value::value(); }
+
+  protected:
+    inline virtual size_type size() const override { return map_.size(); }
+
+    inline virtual bool empty() const override { return map_.empty(); }
+
+    inline virtual bool has_key(const key_type& key) const override
+    {
+      return map_.find(key) != map_.cend();
+    }
+
+    inline virtual bool touch_key(const key_type& key) const override
+    {
+      // pass the touch on to the chained policy
+      if (!ChainedCachingPolicy::touch_key(key))
+        return false;
+
+      // check if we have the key cached
+      auto it = map_.find(key);
+      if (it == map_.cend())
+        return false;
+
+      // touches of keys in A1in are considered to be correlated
+      if (it->second.in_main_)
+        main_.splice(main_.begin(), main_, it->second.position_);
+
+      return true;
+    }
+
+    template<typename... Args>
+    inline void insert_key(std::vector<key_type>& expired_keys, const key_type& key, Args&&... args)
+    {
+      // insert the key into the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::insert_key(expired_keys, key, std::forward<Args>(args)...);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      // if we already have the key it counts as a touch
+      auto it = map_.find(key);
+      if (it != map_.cend())
+      {
+        if (it->second.in_main_)
+          main_.splice(main_.begin(), main_, it->second.position_);
+        return;
+      }
+
+      // keys which have been evicted from A1in recently go into Am
+      const bool in_main = out_.erase(key);
+
+      // check if we need to expire a key as well
+      if (is_full())
+        evict_key(expired_keys);
+
+      list& keys = in_main ? main_ : in_;
+      keys.push_front(key);
+      map_[key] = entry { keys.begin(), in_main };
+    }
+
+    inline virtual bool erase_key(const key_type& key) override
+    {
+      auto it = map_.find(key);
+      if (it == map_.cend())
+        return false;
+
+      ChainedCachingPolicy::erase_key(key);
+
+      erase_entry(it);
+
+      return true;
+    }
+
+    inline virtual void clear_keys() override
+    {
+      ChainedCachingPolicy::clear_keys();
+
+      map_.clear();
+      in_.clear();
+      main_.clear();
+      out_.clear();
+    }
+
+    virtual void expire_keys(std::vector<key_type>& expired_keys) const override
+    {
+      // expire on the chained policy
+      const size_type first_expired_key = expired_keys.size();
+      ChainedCachingPolicy::expire_keys(expired_keys);
+
+      // remove all the keys that were expired in the chained policy
+      erase_keys(expired_keys, first_expired_key);
+
+      // nothing else to do because we expire on insert
+    }
+
+    // changes the maximum size of a policy with a dynamic size. the keys
+    // exceeding the new maximum size have to be removed using evict_key()
+    inline void set_max_size(size_type max_size)
+    {
+      static_assert(MaxSize == dynamic, "only a caching policy with a dynamic size can be resized");
+
+      max_size_value::set_value(max_size);
+    }
+
+    // expires the oldest key of A1in if it exceeds its share of the maximum
+    // size and the least recently used key of Am otherwise
+    bool evict_key(std::vector<key_type>& expired_keys)
+    {
+      if (map_.empty())
+        return false;
+
+      if (!in_.empty() && (in_.size() > in_size() || main_.empty()))
+      {
+        const key_type key = in_.back();
+        evict_entry(map_.find(key), expired_keys);
+
+        out_.push(key);
+        while (out_.size() > out_size())
+          out_.pop();
+      }
+      else
+        evict_entry(map_.find(main_.back()), expired_keys);
+
+      return true;
+    }
+
+  private:
+    using max_size_value = policy::dynamic_value<MaxSize, ChainedCachingPolicy>;
+
+    using list = std::list<key_type>;
+    using list_iterator = typename list::iterator;
+
+    struct entry
+    {
+      list_iterator position_;
+      bool in_main_;
+    };
+
+    using map = std::unordered_map<key_type, entry>;
+    using map_iterator = typename map::iterator;
+
+    inline bool is_full() const
+    {
+      return map_.size() >= max_size();
+    }
+
+    inline size_type in_size() const
+    {
+      const size_type size = max_size() / 4;
+      return size > 0 ? size : 1;
+    }
+
+    inline size_type out_size() const
+    {
+      const size_type size = max_size() / 2;
+      return size > 0 ? size : 1;
+    }
+
+    inline void erase_entry(map_iterator it) const
+    {
+      if (it->second.in_main_)
+        main_.erase(it->second.position_);
+      else
+        in_.erase(it->second.position_);
+
+      map_.erase(it);
+    }
+
+    inline void evict_entry(map_iterator it, std::vector<key_type>& expired_keys)
+    {
+      const key_type key = it->first;
+      ChainedCachingPolicy::erase_key(key);
+
+      erase_entry(it);
+
+      expired_keys.push_back(key);
+    }
+
+    void erase_keys(const std::vector<key_type>& keys, size_type first_key) const
+    {
+      for (size_type index = first_key; index < keys.size(); ++index)
+      {
+        const key_type& key = keys[index];
+        auto it = map_.find(key);
+        if (it == map_.end())
+          continue;
+
+        erase_entry(it);
+      }
+    }
+
+    mutable list in_;
+    mutable list main_;
+    mutable map map_;
+    ghost_list<key_type> out_;
+  };
+}
+}
+
+#endif  // CPP_CACHE_POLICY_TWO_Q_H_
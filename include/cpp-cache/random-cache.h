@@ -11,8 +11,8 @@
 
 namespace cpp_cache
 {
-  template<class Key, class T, size_t MaxSize, class StoragePolicy = storage::map<Key, T>, class LockingPolicy = no_locking>
-  using random_cache = cpp_cache::cache<Key, T, policy::random<Key, MaxSize>, StoragePolicy, LockingPolicy>;
+  template<class Key, class T, size_t MaxSize, class StoragePolicy = storage::map<Key, T>, class LockingPolicy = no_locking, class Weigher = unweighted>
+  using random_cache = cpp_cache::cache<Key, T, policy::random<Key, MaxSize>, StoragePolicy, LockingPolicy, Weigher>;
 }
 
 #endif  // CPP_CACHE_RANDOM_CACHE_H_
\ No newline at end of file
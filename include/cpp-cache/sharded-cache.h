@@ -0,0 +1,228 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ */
+
+#ifndef CPP_CACHE_SHARDED_CACHE_H_
+#define CPP_CACHE_SHARDED_CACHE_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "cache.h"
+
+namespace cpp_cache
+{
+  // helper to determine the maximum size of a single shard so that all shards
+  // together can hold (at least) the given number of elements
+  constexpr size_t shard_size(size_t max_size, size_t shards)
+  {
+    return (max_size + shards - 1) / shards;
+  }
+
+  // a cache front-end which distributes its keys over a fixed number of
+  // independent caches (shards) each with its own caching policy, storage
+  // policy and lock so that operations on different shards don't contend.
+  // the given caching policy describes a single shard (see shard_size()).
+  // the maximum weight is split evenly across all shards.
+  template<class Key, class T, class CachingPolicy, class StoragePolicy, class LockingPolicy = std::mutex, size_t Shards = 16, class Hash = std::hash<Key>, class Weigher = unweighted>
+  class sharded_cache
+  {
+    static_assert(Shards > 0, "sharded_cache requires at least one shard");
+
+  public:
+    using key_type = Key;
+    using cached_type = T;
+    using caching_policy = CachingPolicy;
+    using storage_policy = StoragePolicy;
+    using locking_policy = LockingPolicy;
+    using hasher = Hash;
+    using weigher = Weigher;
+    using shard_type = cache<Key, T, CachingPolicy, StoragePolicy, LockingPolicy, Weigher>;
+    using size_type = typename caching_policy::size_type;
+    using weight_type = typename shard_type::weight_type;
+
+    explicit sharded_cache(const hasher& hash = hasher())
+      : shards_()
+      , hash_(hash)
+    {
+      for (auto& shard : shards_)
+        shard.reset(new shard_type());
+    }
+
+    // all arguments after the hasher are passed on to the caching policy of
+    // every shard (e.g. the maximum size of a single shard of a caching policy
+    // with a dynamic size)
+    template<typename... CachingPolicyArgs>
+    sharded_cache(const hasher& hash, CachingPolicyArgs&&... args)
+      : shards_()
+      , hash_(hash)
+    {
+      for (auto& shard : shards_)
+        shard.reset(new shard_type(args...));
+    }
+
+    ~sharded_cache() = default;
+
+    static constexpr size_t shard_count() { return Shards; }
+
+    size_type max_size() const
+    {
+      return shards_.front()->max_size() * Shards;
+    }
+
+    size_type size() const
+    {
+      size_type size = 0;
+      for (const auto& shard : shards_)
+        size += shard->size();
+
+      return size;
+    }
+
+    weight_type weight() const
+    {
+      weight_type weight = 0;
+      for (const auto& shard : shards_)
+        weight += shard->weight();
+
+      return weight;
+    }
+
+    weight_type max_weight() const
+    {
+      weight_type max_weight = 0;
+      for (const auto& shard : shards_)
+      {
+        // an unlimited shard makes the whole cache unlimited
+        const weight_type shard_max_weight = shard->max_weight();
+        if (shard_max_weight > std::numeric_limits<weight_type>::max() - max_weight)
+          return std::numeric_limits<weight_type>::max();
+
+        max_weight += shard_max_weight;
+      }
+
+      return max_weight;
+    }
+
+    // splits the given maximum weight across all shards. a single value can't
+    // be heavier than the maximum weight of its shard.
+    void set_max_weight(weight_type max_weight)
+    {
+      const weight_type shard_max_weight = max_weight / Shards;
+      const weight_type remainder = max_weight % Shards;
+      for (size_t index = 0; index < Shards; ++index)
+        shards_[index]->set_max_weight(shard_max_weight + (index < remainder ? 1 : 0));
+    }
+
+    bool empty() const
+    {
+      for (const auto& shard : shards_)
+      {
+        if (!shard->empty())
+          return false;
+      }
+
+      return true;
+    }
+
+    bool has(const key_type& key) const
+    {
+      return shard(key).has(key);
+    }
+
+    const cached_type& get(const key_type& key) const
+    {
+      return shard(key).get(key);
+    }
+
+    bool try_get(const key_type& key, cached_type& value) const
+    {
+      return shard(key).try_get(key, value);
+    }
+
+    const cached_type* find(const key_type& key) const
+    {
+      return shard(key).find(key);
+    }
+
+    bool touch(const key_type& key)
+    {
+      return shard(key).touch(key);
+    }
+
+    template<typename... CachingPolicyArgs>
+    bool insert(const key_type& key, const cached_type& value, CachingPolicyArgs&&... args)
+    {
+      return shard(key).insert(key, value, std::forward<CachingPolicyArgs>(args)...);
+    }
+
+    template<class Loader, typename... CachingPolicyArgs>
+    cached_type get_or_load(const key_type& key, Loader&& loader, CachingPolicyArgs&&... args)
+    {
+      return shard(key).get_or_load(key, std::forward<Loader>(loader), std::forward<CachingPolicyArgs>(args)...);
+    }
+
+    void erase(const key_type& key)
+    {
+      shard(key).erase(key);
+    }
+
+    void clear()
+    {
+      for (auto& shard : shards_)
+        shard->clear();
+    }
+
+    // changes the maximum size of every shard of a caching policy with a
+    // dynamic size (see shard_size())
+    void resize(size_type max_size)
+    {
+      for (auto& shard : shards_)
+        shard->resize(max_size);
+    }
+
+    // changes the default maximum age of every shard of a caching policy with
+    // a dynamic default maximum age
+    void set_default_max_age(size_t max_age_ms)
+    {
+      for (auto& shard : shards_)
+        shard->set_default_max_age(max_age_ms);
+    }
+
+  private:
+    inline size_t shard_index(const key_type& key) const
+    {
+      // std::hash is the identity for integral types so mix the bits of the
+      // hash to avoid mapping regular key patterns onto the same shard
+      uint64_t hash = static_cast<uint64_t>(hash_(key));
+      hash ^= hash >> 33;
+      hash *= UINT64_C(0xff51afd7ed558ccd);
+      hash ^= hash >> 33;
+
+      return static_cast<size_t>(hash % Shards);
+    }
+
+    inline shard_type& shard(const key_type& key)
+    {
+      return *shards_[shard_index(key)];
+    }
+
+    inline const shard_type& shard(const key_type& key) const
+    {
+      return *shards_[shard_index(key)];
+    }
+
+    // the shards can neither be copied nor moved so every shard is allocated
+    // on its own to be able to pass arguments to its caching policy
+    std::array<std::unique_ptr<shard_type>, Shards> shards_;
+    hasher hash_;
+  };
+}
+
+#endif  // CPP_CACHE_SHARDED_CACHE_H_
@@ -0,0 +1,30 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ */
+
+#ifndef CPP_CACHE_STORAGE_ENTRY_H_
+#define CPP_CACHE_STORAGE_ENTRY_H_
+
+namespace cpp_cache
+{
+namespace storage
+{
+  // storage policy which doesn't store anything itself but leaves storing
+  // the values to the entries of a caching policy chain built on top of
+  // policy::entry_table (see policy/entry.h)
+  template<class Key, class T>
+  class entry
+  {
+  public:
+    using key_type = Key;
+    using stored_type = T;
+
+    static constexpr bool stored_in_caching_policy = true;
+
+    entry() = default;
+    ~entry() = default;
+  };
+}
+}
+
+#endif  // CPP_CACHE_STORAGE_ENTRY_H_
@@ -27,9 +27,13 @@ namespace storage
     }
 
   protected:
-    const stored_type& get_from_storage(const key_type& key) const
+    const stored_type* find_in_storage(const key_type& key) const
     {
-      return map_.at(key);
+      auto it = map_.find(key);
+      if (it == map_.end())
+        return nullptr;
+
+      return &it->second;
     }
 
     void insert_into_storage(const key_type& key, const stored_type& value)
@@ -0,0 +1,18 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ */
+
+#ifndef CPP_CACHE_TINYLFU_CACHE_H_
+#define CPP_CACHE_TINYLFU_CACHE_H_
+
+#include "cache.h"
+#include "policy/tinylfu.h"
+#include "storage/map.h"
+
+namespace cpp_cache
+{
+  template<class Key, class T, size_t MaxSize, class StoragePolicy = storage::map<Key, T>, class LockingPolicy = no_locking, class Weigher = unweighted>
+  using tinylfu_cache = cpp_cache::cache<Key, T, policy::tinylfu<Key, MaxSize>, StoragePolicy, LockingPolicy, Weigher>;
+}
+
+#endif  // CPP_CACHE_TINYLFU_CACHE_H_
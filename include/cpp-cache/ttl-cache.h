@@ -11,8 +11,8 @@
 
 namespace cpp_cache
 {
-  template<class Key, class T, size_t MaxAgeMs, class StoragePolicy = storage::map<Key, T>, class LockingPolicy = no_locking>
-  using ttl_cache = cpp_cache::cache<Key, T, policy::ttl<Key, MaxAgeMs>, StoragePolicy, LockingPolicy>;
+  template<class Key, class T, size_t MaxAgeMs, class StoragePolicy = storage::map<Key, T>, class LockingPolicy = no_locking, class Weigher = unweighted>
+  using ttl_cache = cpp_cache::cache<Key, T, policy::ttl<Key, MaxAgeMs>, StoragePolicy, LockingPolicy, Weigher>;
 }
 
 #endif  // CPP_CACHE_TTL_CACHE_H_
\ No newline at end of file
@@ -0,0 +1,103 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cpp-signals; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+
+#include <catch.hpp>
+
+#include <cpp-cache/adaptive-cache.h>
+
+TEST_CASE("adaptive", "[adaptive]")
+{
+  using key_type = int;
+  using value_type = std::string;
+
+  SECTION("lru")
+  {
+    const size_t cache_size = 3;
+
+    // the first candidate (LRU) is active until enough keys have been sampled
+    cpp_cache::adaptive_cache<key_type, value_type, cache_size> adaptive_cache;
+
+    REQUIRE(adaptive_cache.max_size() == cache_size);
+    REQUIRE(adaptive_cache.empty() == true);
+    REQUIRE(adaptive_cache.active_candidate() == 0);
+    REQUIRE(adaptive_cache.touch(1) == false);
+
+    adaptive_cache.insert(1, "1");
+    adaptive_cache.insert(2, "2");
+    adaptive_cache.insert(3, "3");
+    REQUIRE(adaptive_cache.get(1) == "1");
+
+    adaptive_cache.insert(4, "4");
+    REQUIRE(adaptive_cache.size() == cache_size);
+    REQUIRE(adaptive_cache.has(2) == false);
+    REQUIRE(adaptive_cache.has(1) == true);
+
+    adaptive_cache.erase(1);
+    REQUIRE(adaptive_cache.size() == 2);
+    REQUIRE(adaptive_cache.has(1) == false);
+
+    adaptive_cache.clear();
+    REQUIRE(adaptive_cache.empty() == true);
+    REQUIRE(adaptive_cache.has(3) == false);
+  }
+
+  SECTION("switch")
+  {
+    const size_t cache_size = 8;
+    const key_type hot_keys = 4;
+    const key_type cold_keys = 8;
+
+    // a few keys used twice in a row mixed with many keys only used once keep
+    // evicting the keys used twice from an LRU cache but not from an LFU
+    // cache. all keys are sampled.
+    using candidates = cpp_cache::policy::adaptive_candidates<cpp_cache::policy::lru, cpp_cache::policy::lfu>;
+    using policy = cpp_cache::policy::adaptive<key_type, cache_size, candidates, 1, 64>;
+    cpp_cache::cache<key_type, value_type, policy, cpp_cache::storage::map<key_type, value_type>> adaptive_cache;
+
+    key_type next_cold_key = hot_keys;
+    size_t hits = 0;
+    for (size_t round = 0; round < 20; ++round)
+    {
+      if (round == 10)
+      {
+        REQUIRE(adaptive_cache.active_candidate() == 1);
+        hits = 0;
+      }
+
+      for (key_type key = 0; key < hot_keys; ++key)
+      {
+        if (adaptive_cache.touch(key))
+          ++hits;
+        else
+          adaptive_cache.insert(key, std::to_string(key));
+        REQUIRE(adaptive_cache.touch(key) == true);
+      }
+
+      for (key_type key = 0; key < cold_keys; ++key, ++next_cold_key)
+        adaptive_cache.insert(next_cold_key, std::to_string(next_cold_key));
+
+      REQUIRE(adaptive_cache.size() == cache_size);
+    }
+
+    // the keys used twice aren't evicted anymore
+    REQUIRE(hits == 10 * static_cast<size_t>(hot_keys));
+  }
+}
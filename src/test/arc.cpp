@@ -0,0 +1,89 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cpp-signals; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+
+#include <catch.hpp>
+
+#include <cpp-cache/arc-cache.h>
+
+TEST_CASE("arc", "[arc]")
+{
+  using key_type = int;
+  using value_type = std::string;
+  const size_t cache_size = 4;
+
+  cpp_cache::arc_cache<key_type, value_type, cache_size> arc_cache;
+
+  REQUIRE(arc_cache.max_size() == cache_size);
+  REQUIRE(arc_cache.empty() == true);
+  REQUIRE(arc_cache.target_recent_size() == 0);
+  REQUIRE(arc_cache.touch(1) == false);
+
+  for (key_type key = 1; key <= 4; ++key)
+    arc_cache.insert(key, std::to_string(key));
+  REQUIRE(arc_cache.size() == 4);
+
+  // one and two are used a second time and move to the frequency list
+  REQUIRE(arc_cache.get(1) == "1");
+  REQUIRE(arc_cache.get(2) == "2");
+
+  // the oldest key of the recency list is evicted
+  arc_cache.insert(5, "5");
+  REQUIRE(arc_cache.size() == 4);
+  REQUIRE(arc_cache.has(3) == false);
+  REQUIRE(arc_cache.has(4) == true);
+
+  // a scan doesn't evict the frequently used keys
+  for (key_type key = 6; key <= 8; ++key)
+    arc_cache.insert(key, std::to_string(key));
+  REQUIRE(arc_cache.size() == 4);
+  REQUIRE(arc_cache.has(1) == true);
+  REQUIRE(arc_cache.has(2) == true);
+  REQUIRE(arc_cache.has(5) == false);
+  REQUIRE(arc_cache.has(6) == false);
+  REQUIRE(arc_cache.has(7) == true);
+  REQUIRE(arc_cache.has(8) == true);
+
+  // five was evicted too early so the recency list grows
+  arc_cache.insert(5, "5");
+  REQUIRE(arc_cache.target_recent_size() == 1);
+  REQUIRE(arc_cache.has(5) == true);
+  REQUIRE(arc_cache.has(7) == false);
+  REQUIRE(arc_cache.has(8) == true);
+
+  // one is the oldest key of the frequency list
+  arc_cache.insert(9, "9");
+  arc_cache.insert(10, "10");
+  REQUIRE(arc_cache.has(1) == false);
+  REQUIRE(arc_cache.has(2) == true);
+  REQUIRE(arc_cache.has(5) == true);
+
+  // one was evicted from the frequency list so the recency list shrinks
+  arc_cache.insert(1, "1");
+  REQUIRE(arc_cache.target_recent_size() == 0);
+  REQUIRE(arc_cache.has(1) == true);
+
+  arc_cache.erase(1);
+  REQUIRE(arc_cache.has(1) == false);
+
+  arc_cache.clear();
+  REQUIRE(arc_cache.empty() == true);
+  REQUIRE(arc_cache.target_recent_size() == 0);
+}
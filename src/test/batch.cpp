@@ -0,0 +1,97 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cpp-signals; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <iterator>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <cpp-cache/lru-cache.h>
+#include <cpp-cache/ttl-cache.h>
+
+TEST_CASE("batch", "[batch]")
+{
+  using key_type = int;
+  using value_type = std::string;
+  const size_t cache_size = 3;
+
+  const std::vector<std::pair<key_type, value_type>> values = {
+    { 1, "one" },
+    { 2, "two" },
+    { 3, "three" },
+    { 4, "four" }
+  };
+
+  cpp_cache::lru_cache<key_type, value_type, cache_size> lru_cache;
+
+  // only the last keys fit into the cache
+  REQUIRE(lru_cache.insert_many(values.cbegin(), values.cend()) == values.size());
+  REQUIRE(lru_cache.size() == cache_size);
+  REQUIRE(lru_cache.has(1) == false);
+  REQUIRE(lru_cache.has(2) == true);
+  REQUIRE(lru_cache.has(3) == true);
+  REQUIRE(lru_cache.has(4) == true);
+
+  const std::vector<key_type> keys = { 4, 1, 2, 5 };
+  std::map<key_type, value_type> found;
+  REQUIRE(lru_cache.get_many(keys.cbegin(), keys.cend(), std::inserter(found, found.end())) == 2);
+  REQUIRE(found.size() == 2);
+  REQUIRE(found[2] == "two");
+  REQUIRE(found[4] == "four");
+
+  // the found keys have been touched so three is the least recently used key
+  lru_cache.insert(5, "five");
+  REQUIRE(lru_cache.has(3) == false);
+  REQUIRE(lru_cache.has(2) == true);
+  REQUIRE(lru_cache.has(4) == true);
+
+  std::vector<std::pair<key_type, value_type>> found_values;
+  REQUIRE(lru_cache.get_many(keys.cbegin(), keys.cend(), std::back_inserter(found_values)) == 3);
+  REQUIRE(found_values.size() == 3);
+  REQUIRE(found_values[0].first == 4);
+  REQUIRE(found_values[1].first == 2);
+  REQUIRE(found_values[2].first == 5);
+  REQUIRE(found_values[2].second == "five");
+
+  SECTION("caching policy arguments")
+  {
+    const std::vector<std::pair<key_type, value_type>> more_values = {
+      { 5, "five" },
+      { 6, "six" },
+      { 7, "seven" },
+      { 8, "eight" }
+    };
+
+    cpp_cache::ttl_cache<key_type, value_type, 10000> ttl_cache;
+
+    // every key of a batch gets the same maximum age
+    REQUIRE(ttl_cache.insert_many(values.cbegin(), values.cend(), static_cast<size_t>(9000)) == values.size());
+    REQUIRE(ttl_cache.insert_many(more_values.cbegin(), more_values.cend(), static_cast<size_t>(1000)) == more_values.size());
+    REQUIRE(ttl_cache.size() == values.size() + more_values.size());
+
+    // the keys of the second batch expire first although they were inserted last
+    ttl_cache.set_max_weight(values.size());
+    for (const auto& value : values)
+      REQUIRE(ttl_cache.has(value.first) == true);
+    for (const auto& value : more_values)
+      REQUIRE(ttl_cache.has(value.first) == false);
+  }
+}
@@ -0,0 +1,125 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cpp-signals; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <cpp-cache/buffered-lru-cache.h>
+
+TEST_CASE("buffered_lru", "[buffered_lru]")
+{
+  using key_type = int;
+  using value_type = std::string;
+
+  SECTION("single thread")
+  {
+    const size_t cache_size = 2;
+
+    const key_type one_key = 1;
+    const value_type one_value = "one";
+    const key_type two_key = 2;
+    const value_type two_value = "two";
+    const key_type three_key = 3;
+    const value_type three_value = "three";
+
+    cpp_cache::buffered_lru_cache<key_type, value_type, cache_size> lru_cache;
+
+    REQUIRE(lru_cache.max_size() == cache_size);
+    REQUIRE(lru_cache.empty() == true);
+
+    lru_cache.insert(one_key, one_value);
+    lru_cache.insert(two_key, two_value);
+    REQUIRE(lru_cache.size() == 2);
+
+    // the buffered touch is applied before the next key is inserted
+    REQUIRE(lru_cache.get(one_key) == one_value);
+    lru_cache.insert(three_key, three_value);
+    REQUIRE(lru_cache.has(one_key) == true);
+    REQUIRE(lru_cache.has(two_key) == false);
+    REQUIRE(lru_cache.has(three_key) == true);
+
+    // touches of erased keys are dropped
+    REQUIRE(lru_cache.touch(three_key) == true);
+    lru_cache.erase(three_key);
+    REQUIRE(lru_cache.size() == 1);
+
+    lru_cache.insert(two_key, two_value);
+    REQUIRE(lru_cache.touch(one_key) == true);
+    lru_cache.insert(three_key, three_value);
+    REQUIRE(lru_cache.has(one_key) == true);
+    REQUIRE(lru_cache.has(two_key) == false);
+    REQUIRE(lru_cache.has(three_key) == true);
+
+    // more touches than fit into a read buffer
+    for (size_t index = 0; index < 100; ++index)
+      REQUIRE(lru_cache.touch(three_key) == true);
+    lru_cache.insert(two_key, two_value);
+    REQUIRE(lru_cache.has(one_key) == false);
+    REQUIRE(lru_cache.has(two_key) == true);
+    REQUIRE(lru_cache.has(three_key) == true);
+
+    lru_cache.clear();
+    REQUIRE(lru_cache.empty() == true);
+    REQUIRE(lru_cache.touch(three_key) == false);
+  }
+
+  SECTION("concurrent reads")
+  {
+    const size_t cache_size = 64;
+    const size_t reader_count = 8;
+    const size_t iterations = 10000;
+
+    cpp_cache::buffered_lru_cache<key_type, value_type, cache_size, cpp_cache::storage::map<key_type, value_type>, cpp_cache::shared_locking> lru_cache;
+    for (key_type key = 0; key < static_cast<key_type>(cache_size); ++key)
+      lru_cache.insert(key, std::to_string(key));
+
+    std::atomic<size_t> hits(0);
+    std::vector<std::thread> threads;
+
+    for (size_t index = 0; index < reader_count; ++index)
+    {
+      threads.emplace_back([&lru_cache, &hits, cache_size, iterations, index]()
+      {
+        value_type value;
+        for (size_t iteration = 0; iteration < iterations; ++iteration)
+        {
+          if (lru_cache.try_get(static_cast<key_type>((iteration + index) % cache_size), value))
+            ++hits;
+        }
+      });
+    }
+
+    // keep inserting new keys while the cached ones are being read
+    threads.emplace_back([&lru_cache, cache_size]()
+    {
+      for (size_t key = cache_size; key < 2 * cache_size; ++key)
+        lru_cache.insert(static_cast<key_type>(key), std::to_string(key));
+    });
+
+    for (auto& thread : threads)
+      thread.join();
+
+    REQUIRE(hits > 0);
+    REQUIRE(lru_cache.size() == cache_size);
+  }
+}
@@ -0,0 +1,126 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cpp-signals; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <memory>
+#include <string>
+
+#include <catch.hpp>
+
+#include <cpp-cache/clock-cache.h>
+
+TEST_CASE("clock", "[clock]")
+{
+  using key_type = int;
+  using value_type = std::string;
+  const size_t cache_size = 3;
+
+  const key_type one_key = 1;
+  const value_type one_value = "one";
+  const key_type two_key = 2;
+  const value_type two_value = "two";
+  const key_type three_key = 3;
+  const value_type three_value = "three";
+  const key_type four_key = 4;
+  const value_type four_value = "four";
+  const key_type five_key = 5;
+  const value_type five_value = "five";
+
+  cpp_cache::clock_cache<key_type, value_type, cache_size> clock_cache;
+
+  REQUIRE(clock_cache.max_size() == cache_size);
+  REQUIRE(clock_cache.size() == 0);
+  REQUIRE(clock_cache.empty() == true);
+  REQUIRE(clock_cache.has(one_key) == false);
+  REQUIRE(clock_cache.touch(one_key) == false);
+
+  clock_cache.insert(one_key, one_value);
+  clock_cache.insert(two_key, two_value);
+  clock_cache.insert(three_key, three_value);
+  REQUIRE(clock_cache.size() == 3);
+  REQUIRE(clock_cache.get(one_key) == one_value);
+  REQUIRE(clock_cache.get(two_key) == two_value);
+  REQUIRE(clock_cache.get(three_key) == three_value);
+
+  // without any references the hand evicts the oldest key
+  clock_cache.clear();
+  clock_cache.insert(one_key, one_value);
+  clock_cache.insert(two_key, two_value);
+  clock_cache.insert(three_key, three_value);
+  clock_cache.insert(four_key, four_value);
+  REQUIRE(clock_cache.size() == 3);
+  REQUIRE(clock_cache.has(one_key) == false);
+  REQUIRE(clock_cache.has(two_key) == true);
+  REQUIRE(clock_cache.has(three_key) == true);
+  REQUIRE(clock_cache.has(four_key) == true);
+
+  // the referenced key gets a second chance
+  REQUIRE(clock_cache.touch(two_key) == true);
+  clock_cache.insert(five_key, five_value);
+  REQUIRE(clock_cache.has(two_key) == true);
+  REQUIRE(clock_cache.has(three_key) == false);
+  REQUIRE(clock_cache.has(four_key) == true);
+  REQUIRE(clock_cache.has(five_key) == true);
+
+  // the reference bit of two has been cleared by the hand
+  clock_cache.insert(one_key, one_value);
+  REQUIRE(clock_cache.has(one_key) == true);
+  REQUIRE(clock_cache.has(two_key) == true);
+  REQUIRE(clock_cache.has(four_key) == false);
+  REQUIRE(clock_cache.has(five_key) == true);
+
+  clock_cache.insert(three_key, three_value);
+  REQUIRE(clock_cache.has(two_key) == false);
+  REQUIRE(clock_cache.has(three_key) == true);
+
+  // erased keys free their slot for the next key
+  clock_cache.erase(one_key);
+  REQUIRE(clock_cache.size() == 2);
+  REQUIRE(clock_cache.has(one_key) == false);
+  clock_cache.insert(four_key, four_value);
+  REQUIRE(clock_cache.size() == 3);
+  REQUIRE(clock_cache.has(three_key) == true);
+  REQUIRE(clock_cache.has(four_key) == true);
+  REQUIRE(clock_cache.has(five_key) == true);
+
+  clock_cache.clear();
+  REQUIRE(clock_cache.size() == 0);
+  REQUIRE(clock_cache.empty() == true);
+  REQUIRE(clock_cache.has(five_key) == false);
+
+  SECTION("free slots")
+  {
+    using pointer_key_type = std::shared_ptr<int>;
+    cpp_cache::clock_cache<pointer_key_type, value_type, cache_size> pointer_cache;
+
+    const pointer_key_type pointer_one_key = std::make_shared<int>(1);
+    const pointer_key_type pointer_two_key = std::make_shared<int>(2);
+    pointer_cache.insert(pointer_one_key, one_value);
+    pointer_cache.insert(pointer_two_key, two_value);
+    REQUIRE(pointer_one_key.use_count() > 1);
+
+    // erased and evicted keys aren't kept alive by their free slot
+    pointer_cache.erase(pointer_one_key);
+    REQUIRE(pointer_one_key.use_count() == 1);
+
+    for (int key = 3; key <= 6; ++key)
+      pointer_cache.insert(std::make_shared<int>(key), value_type());
+    REQUIRE(pointer_cache.has(pointer_two_key) == false);
+    REQUIRE(pointer_two_key.use_count() == 1);
+  }
+}
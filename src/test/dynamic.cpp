@@ -0,0 +1,180 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cpp-signals; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <catch.hpp>
+
+#include <cpp-cache/entry-cache.h>
+#include <cpp-cache/fifo-cache.h>
+#include <cpp-cache/lfu-cache.h>
+#include <cpp-cache/lru-cache.h>
+#include <cpp-cache/random-cache.h>
+#include <cpp-cache/tinylfu-cache.h>
+#include <cpp-cache/ttl-cache.h>
+#include <cpp-cache/policy/lru.h>
+#include <cpp-cache/policy/ttl.h>
+#include <cpp-cache/storage/map.h>
+
+TEST_CASE("dynamic size", "[dynamic]")
+{
+  using key_type = int;
+  using value_type = std::string;
+
+  const key_type one_key = 1;
+  const value_type one_value = "one";
+  const key_type two_key = 2;
+  const value_type two_value = "two";
+  const key_type three_key = 3;
+  const value_type three_value = "three";
+  const key_type four_key = 4;
+  const value_type four_value = "four";
+
+  cpp_cache::lru_cache<key_type, value_type, cpp_cache::policy::dynamic> lru_cache(3);
+
+  REQUIRE(lru_cache.max_size() == 3);
+  REQUIRE(lru_cache.empty() == true);
+
+  // only a dynamic maximum size is stored
+  REQUIRE(sizeof(cpp_cache::policy::lru<key_type, 3>) < sizeof(cpp_cache::policy::lru<key_type, cpp_cache::policy::dynamic>));
+
+  lru_cache.insert(one_key, one_value);
+  lru_cache.insert(two_key, two_value);
+  lru_cache.insert(three_key, three_value);
+  REQUIRE(lru_cache.size() == 3);
+
+  // make two the least recently used key
+  REQUIRE(lru_cache.touch(one_key) == true);
+
+  lru_cache.insert(four_key, four_value);
+  REQUIRE(lru_cache.size() == 3);
+  REQUIRE(lru_cache.has(two_key) == false);
+
+  // shrinking expires the least recently used keys
+  lru_cache.resize(1);
+  REQUIRE(lru_cache.max_size() == 1);
+  REQUIRE(lru_cache.size() == 1);
+  REQUIRE(lru_cache.has(one_key) == false);
+  REQUIRE(lru_cache.has(three_key) == false);
+  REQUIRE(lru_cache.has(four_key) == true);
+
+  value_type tmp;
+  REQUIRE(lru_cache.try_get(one_key, tmp) == false);
+  REQUIRE(lru_cache.try_get(three_key, tmp) == false);
+  REQUIRE(lru_cache.get(four_key) == four_value);
+
+  // growing doesn't expire anything
+  lru_cache.resize(2);
+  REQUIRE(lru_cache.max_size() == 2);
+  REQUIRE(lru_cache.size() == 1);
+
+  lru_cache.insert(one_key, one_value);
+  REQUIRE(lru_cache.size() == 2);
+  lru_cache.insert(two_key, two_value);
+  REQUIRE(lru_cache.size() == 2);
+  REQUIRE(lru_cache.has(four_key) == false);
+  REQUIRE(lru_cache.get(one_key) == one_value);
+  REQUIRE(lru_cache.get(two_key) == two_value);
+
+  SECTION("other caching policies")
+  {
+    cpp_cache::fifo_cache<key_type, value_type, cpp_cache::policy::dynamic> fifo_cache(4);
+    cpp_cache::lfu_cache<key_type, value_type, cpp_cache::policy::dynamic> lfu_cache(4);
+    cpp_cache::random_cache<key_type, value_type, cpp_cache::policy::dynamic> random_cache(4);
+    cpp_cache::tinylfu_cache<key_type, value_type, cpp_cache::policy::dynamic> tinylfu_cache(4);
+    cpp_cache::entry_lru_cache<key_type, value_type, cpp_cache::policy::dynamic> entry_lru_cache(4);
+
+    for (key_type key = 0; key < 4; ++key)
+    {
+      fifo_cache.insert(key, one_value);
+      lfu_cache.insert(key, one_value);
+      random_cache.insert(key, one_value);
+      tinylfu_cache.insert(key, one_value);
+      entry_lru_cache.insert(key, one_value);
+    }
+
+    fifo_cache.resize(2);
+    lfu_cache.resize(2);
+    random_cache.resize(2);
+    tinylfu_cache.resize(2);
+    entry_lru_cache.resize(2);
+
+    REQUIRE(fifo_cache.size() == 2);
+    REQUIRE(lfu_cache.size() == 2);
+    REQUIRE(random_cache.size() == 2);
+    REQUIRE(tinylfu_cache.size() == 2);
+    REQUIRE(entry_lru_cache.size() == 2);
+
+    // the oldest keys are expired first
+    REQUIRE(fifo_cache.has(0) == false);
+    REQUIRE(fifo_cache.has(1) == false);
+    REQUIRE(entry_lru_cache.has(0) == false);
+    REQUIRE(entry_lru_cache.has(1) == false);
+    REQUIRE(entry_lru_cache.get(3) == one_value);
+  }
+}
+
+TEST_CASE("dynamic max age", "[dynamic]")
+{
+  using key_type = int;
+  using value_type = std::string;
+  const size_t ttl_max_age_ms = 200;
+
+  const key_type one_key = 1;
+  const value_type one_value = "one";
+  const key_type two_key = 2;
+  const value_type two_value = "two";
+  const key_type three_key = 3;
+  const value_type three_value = "three";
+
+  cpp_cache::ttl_cache<key_type, value_type, cpp_cache::policy::dynamic> ttl_cache(ttl_max_age_ms);
+  REQUIRE(ttl_cache.default_max_age() == ttl_max_age_ms);
+
+  ttl_cache.insert(one_key, one_value);
+
+  // keys which are already cached keep their maximum age
+  ttl_cache.set_default_max_age(5 * ttl_max_age_ms);
+  REQUIRE(ttl_cache.default_max_age() == 5 * ttl_max_age_ms);
+  ttl_cache.insert(two_key, two_value);
+
+  std::this_thread::sleep_for(std::chrono::duration<int, std::milli>(2 * ttl_max_age_ms));
+  REQUIRE(ttl_cache.has(one_key) == false);
+  REQUIRE(ttl_cache.has(two_key) == true);
+
+  SECTION("chained")
+  {
+    // the maximum size of the lru policy is followed by the default maximum age of the chained ttl policy
+    cpp_cache::cache<key_type, value_type,
+      cpp_cache::policy::lru<key_type, cpp_cache::policy::dynamic, cpp_cache::policy::ttl<key_type, cpp_cache::policy::dynamic>>,
+      cpp_cache::storage::map<key_type, value_type>> lru_ttl_cache(2, ttl_max_age_ms);
+
+    REQUIRE(lru_ttl_cache.max_size() == 2);
+    REQUIRE(lru_ttl_cache.default_max_age() == ttl_max_age_ms);
+
+    lru_ttl_cache.insert(one_key, one_value);
+    lru_ttl_cache.insert(two_key, two_value);
+    lru_ttl_cache.insert(three_key, three_value);
+    REQUIRE(lru_ttl_cache.size() == 2);
+    REQUIRE(lru_ttl_cache.has(one_key) == false);
+
+    std::this_thread::sleep_for(std::chrono::duration<int, std::milli>(2 * ttl_max_age_ms));
+    REQUIRE(lru_ttl_cache.empty() == true);
+  }
+}
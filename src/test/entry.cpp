@@ -0,0 +1,433 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cpp-signals; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <catch.hpp>
+
+#include <cpp-cache/entry-cache.h>
+
+namespace
+{
+  // clock which only moves when it is advanced so that expiring keys can be
+  // tested without sleeping
+  struct manual_clock
+  {
+    using duration = std::chrono::milliseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<manual_clock>;
+    static constexpr bool is_steady = true;
+
+    static time_point now() { return time_point(duration(now_ms)); }
+
+    static void advance_to(rep ms) { now_ms = ms; }
+
+    static rep now_ms;
+  };
+
+  manual_clock::rep manual_clock::now_ms = 0;
+
+  // value which can't be default constructed and counts how often it is copied
+  struct counted_value
+  {
+    explicit counted_value(int value)
+      : value_(value)
+    { }
+
+    counted_value(const counted_value& other)
+      : value_(other.value_)
+    {
+      ++copies;
+    }
+
+    counted_value& operator=(const counted_value& other)
+    {
+      value_ = other.value_;
+      ++assignments;
+      return *this;
+    }
+
+    int value_;
+
+    static size_t copies;
+    static size_t assignments;
+  };
+
+  size_t counted_value::copies = 0;
+  size_t counted_value::assignments = 0;
+}
+
+TEST_CASE("entry-lru", "[entry-lru]")
+{
+  using key_type = int;
+  using value_type = std::string;
+  const size_t cache_size = 2;
+
+  const key_type one_key = 1;
+  const value_type one_value = "one";
+  const key_type two_key = 2;
+  const value_type two_value = "two";
+  const key_type three_key = 3;
+  const value_type three_value = "three";
+  const key_type four_key = 4;
+  const value_type four_value = "four";
+
+  cpp_cache::entry_lru_cache<key_type, value_type, cache_size> entry_lru_cache;
+
+  REQUIRE(entry_lru_cache.max_size() == cache_size);
+  REQUIRE(entry_lru_cache.size() == 0);
+  REQUIRE(entry_lru_cache.empty() == true);
+
+  REQUIRE(entry_lru_cache.has(one_key) == false);
+  REQUIRE(entry_lru_cache.has(two_key) == false);
+  REQUIRE(entry_lru_cache.has(three_key) == false);
+  REQUIRE(entry_lru_cache.has(four_key) == false);
+
+  value_type tmp;
+  REQUIRE(entry_lru_cache.try_get(one_key, tmp) == false);
+  REQUIRE(entry_lru_cache.try_get(two_key, tmp) == false);
+  REQUIRE(entry_lru_cache.try_get(three_key, tmp) == false);
+  REQUIRE(entry_lru_cache.try_get(four_key, tmp) == false);
+
+  try
+  {
+    entry_lru_cache.get(one_key);
+    REQUIRE(false);
+  }
+  catch (std::out_of_range&) { REQUIRE(true); }
+  catch (...) { REQUIRE(false); }
+
+  entry_lru_cache.insert(one_key, one_value);
+  REQUIRE(entry_lru_cache.has(one_key) == true);
+  REQUIRE(entry_lru_cache.try_get(one_key, tmp) == true);
+  REQUIRE(entry_lru_cache.get(one_key) == one_value);
+  REQUIRE(entry_lru_cache.find(one_key) != nullptr);
+  REQUIRE(*entry_lru_cache.find(one_key) == one_value);
+  REQUIRE(entry_lru_cache.find(two_key) == nullptr);
+  REQUIRE(entry_lru_cache.size() == 1);
+  REQUIRE(entry_lru_cache.empty() == false);
+
+  entry_lru_cache.insert(two_key, two_value);
+  REQUIRE(entry_lru_cache.has(two_key) == true);
+  REQUIRE(entry_lru_cache.try_get(two_key, tmp) == true);
+  REQUIRE(entry_lru_cache.get(two_key) == two_value);
+  REQUIRE(entry_lru_cache.size() == 2);
+  REQUIRE(entry_lru_cache.empty() == false);
+  REQUIRE(entry_lru_cache.has(one_key) == true);
+  REQUIRE(entry_lru_cache.try_get(one_key, tmp) == true);
+  REQUIRE(entry_lru_cache.get(one_key) == one_value);
+
+  entry_lru_cache.erase(three_key);
+  REQUIRE(entry_lru_cache.size() == 2);
+  REQUIRE(entry_lru_cache.empty() == false);
+  REQUIRE(entry_lru_cache.has(one_key) == true);
+  REQUIRE(entry_lru_cache.has(two_key) == true);
+
+  entry_lru_cache.erase(one_key);
+  REQUIRE(entry_lru_cache.size() == 1);
+  REQUIRE(entry_lru_cache.empty() == false);
+  REQUIRE(entry_lru_cache.has(one_key) == false);
+  REQUIRE(entry_lru_cache.has(two_key) == true);
+
+  entry_lru_cache.clear();
+  REQUIRE(entry_lru_cache.size() == 0);
+  REQUIRE(entry_lru_cache.empty() == true);
+  REQUIRE(entry_lru_cache.has(one_key) == false);
+  REQUIRE(entry_lru_cache.has(two_key) == false);
+
+  entry_lru_cache.insert(one_key, one_value);
+  REQUIRE(entry_lru_cache.has(one_key) == true);
+
+  entry_lru_cache.insert(two_key, two_value);
+  REQUIRE(entry_lru_cache.has(two_key) == true);
+  REQUIRE(entry_lru_cache.has(one_key) == true);
+
+  entry_lru_cache.insert(three_key, three_value);
+  REQUIRE(entry_lru_cache.has(three_key) == true);
+  REQUIRE(entry_lru_cache.has(two_key) == true);
+  REQUIRE(entry_lru_cache.has(one_key) == false);
+
+  entry_lru_cache.insert(four_key, four_value);
+  REQUIRE(entry_lru_cache.has(four_key) == true);
+  REQUIRE(entry_lru_cache.has(three_key) == true);
+  REQUIRE(entry_lru_cache.has(two_key) == false);
+  REQUIRE(entry_lru_cache.has(one_key) == false);
+
+  entry_lru_cache.insert(one_key, one_value);
+  REQUIRE(entry_lru_cache.has(four_key) == true);
+  REQUIRE(entry_lru_cache.has(three_key) == false);
+  REQUIRE(entry_lru_cache.has(two_key) == false);
+  REQUIRE(entry_lru_cache.has(one_key) == true);
+
+  REQUIRE(entry_lru_cache.get(four_key) == four_value);
+  REQUIRE(entry_lru_cache.has(four_key) == true);
+  REQUIRE(entry_lru_cache.has(three_key) == false);
+  REQUIRE(entry_lru_cache.has(two_key) == false);
+  REQUIRE(entry_lru_cache.has(one_key) == true);
+
+  entry_lru_cache.insert(two_key, two_value);
+  REQUIRE(entry_lru_cache.has(four_key) == true);
+  REQUIRE(entry_lru_cache.has(three_key) == false);
+  REQUIRE(entry_lru_cache.has(two_key) == true);
+  REQUIRE(entry_lru_cache.has(one_key) == false);
+}
+
+TEST_CASE("entry-lru-ttl", "[entry-lru-ttl]")
+{
+  using key_type = int;
+  using value_type = std::string;
+  const size_t cache_size = 2;
+  const size_t ttl_max_age_ms = 200;
+
+  const key_type one_key = 1;
+  const value_type one_value = "one";
+  const key_type two_key = 2;
+  const value_type two_value = "two";
+  const key_type three_key = 3;
+  const value_type three_value = "three";
+  const key_type four_key = 4;
+  const value_type four_value = "four";
+
+  using entry_lru_ttl_cache_t = cpp_cache::entry_lru_ttl_cache<key_type, value_type, cache_size, ttl_max_age_ms>;
+  entry_lru_ttl_cache_t entry_lru_ttl_cache;
+
+  REQUIRE(entry_lru_ttl_cache.max_size() == cache_size);
+  REQUIRE(entry_lru_ttl_cache.default_max_age() == ttl_max_age_ms);
+  REQUIRE(entry_lru_ttl_cache.size() == 0);
+  REQUIRE(entry_lru_ttl_cache.empty() == true);
+
+  REQUIRE(entry_lru_ttl_cache.has(one_key) == false);
+  REQUIRE(entry_lru_ttl_cache.has(two_key) == false);
+  REQUIRE(entry_lru_ttl_cache.has(three_key) == false);
+  REQUIRE(entry_lru_ttl_cache.has(four_key) == false);
+
+  value_type tmp;
+  REQUIRE(entry_lru_ttl_cache.try_get(one_key, tmp) == false);
+  REQUIRE(entry_lru_ttl_cache.try_get(two_key, tmp) == false);
+  REQUIRE(entry_lru_ttl_cache.try_get(three_key, tmp) == false);
+  REQUIRE(entry_lru_ttl_cache.try_get(four_key, tmp) == false);
+
+  try
+  {
+    entry_lru_ttl_cache.get(one_key);
+    REQUIRE(false);
+  }
+  catch (std::out_of_range&) { REQUIRE(true); }
+  catch (...) { REQUIRE(false); }
+
+  entry_lru_ttl_cache.insert(one_key, one_value);
+  REQUIRE(entry_lru_ttl_cache.has(one_key) == true);
+  REQUIRE(entry_lru_ttl_cache.try_get(one_key, tmp) == true);
+  REQUIRE(entry_lru_ttl_cache.get(one_key) == one_value);
+  REQUIRE(entry_lru_ttl_cache.size() == 1);
+  REQUIRE(entry_lru_ttl_cache.empty() == false);
+
+  entry_lru_ttl_cache.insert(two_key, two_value);
+  REQUIRE(entry_lru_ttl_cache.has(two_key) == true);
+  REQUIRE(entry_lru_ttl_cache.try_get(two_key, tmp) == true);
+  REQUIRE(entry_lru_ttl_cache.get(two_key) == two_value);
+  REQUIRE(entry_lru_ttl_cache.size() == 2);
+  REQUIRE(entry_lru_ttl_cache.empty() == false);
+  REQUIRE(entry_lru_ttl_cache.has(one_key) == true);
+  REQUIRE(entry_lru_ttl_cache.try_get(one_key, tmp) == true);
+  REQUIRE(entry_lru_ttl_cache.get(one_key) == one_value);
+
+  entry_lru_ttl_cache.erase(three_key);
+  REQUIRE(entry_lru_ttl_cache.size() == 2);
+  REQUIRE(entry_lru_ttl_cache.empty() == false);
+  REQUIRE(entry_lru_ttl_cache.has(one_key) == true);
+  REQUIRE(entry_lru_ttl_cache.has(two_key) == true);
+
+  entry_lru_ttl_cache.erase(one_key);
+  REQUIRE(entry_lru_ttl_cache.size() == 1);
+  REQUIRE(entry_lru_ttl_cache.empty() == false);
+  REQUIRE(entry_lru_ttl_cache.has(one_key) == false);
+  REQUIRE(entry_lru_ttl_cache.has(two_key) == true);
+
+  entry_lru_ttl_cache.clear();
+  REQUIRE(entry_lru_ttl_cache.size() == 0);
+  REQUIRE(entry_lru_ttl_cache.empty() == true);
+  REQUIRE(entry_lru_ttl_cache.has(one_key) == false);
+  REQUIRE(entry_lru_ttl_cache.has(two_key) == false);
+
+  entry_lru_ttl_cache.insert(one_key, one_value);
+  REQUIRE(entry_lru_ttl_cache.has(one_key) == true);
+
+  entry_lru_ttl_cache.insert(two_key, two_value);
+  REQUIRE(entry_lru_ttl_cache.has(two_key) == true);
+  REQUIRE(entry_lru_ttl_cache.has(one_key) == true);
+
+  entry_lru_ttl_cache.insert(three_key, three_value);
+  REQUIRE(entry_lru_ttl_cache.has(three_key) == true);
+  REQUIRE(entry_lru_ttl_cache.has(two_key) == true);
+  REQUIRE(entry_lru_ttl_cache.has(one_key) == false);
+
+  entry_lru_ttl_cache.insert(four_key, four_value);
+  REQUIRE(entry_lru_ttl_cache.has(four_key) == true);
+  REQUIRE(entry_lru_ttl_cache.has(three_key) == true);
+  REQUIRE(entry_lru_ttl_cache.has(two_key) == false);
+  REQUIRE(entry_lru_ttl_cache.has(one_key) == false);
+
+  std::this_thread::sleep_for(std::chrono::duration<int, std::milli>(2 * ttl_max_age_ms));
+
+  REQUIRE(entry_lru_ttl_cache.has(four_key) == false);
+  REQUIRE(entry_lru_ttl_cache.has(three_key) == false);
+  REQUIRE(entry_lru_ttl_cache.has(two_key) == false);
+  REQUIRE(entry_lru_ttl_cache.has(one_key) == false);
+
+  entry_lru_ttl_cache.insert(one_key, one_value);
+  REQUIRE(entry_lru_ttl_cache.has(one_key) == true);
+
+  entry_lru_ttl_cache.insert(two_key, two_value);
+  REQUIRE(entry_lru_ttl_cache.has(two_key) == true);
+  REQUIRE(entry_lru_ttl_cache.has(one_key) == true);
+
+  std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(0.5 * ttl_max_age_ms));
+
+  REQUIRE(entry_lru_ttl_cache.has(one_key) == true);
+  REQUIRE(entry_lru_ttl_cache.has(two_key) == true);
+
+  REQUIRE(entry_lru_ttl_cache.get(one_key) == one_value);
+
+  std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(0.7 * ttl_max_age_ms));
+
+  REQUIRE(entry_lru_ttl_cache.has(one_key) == true);
+  REQUIRE(entry_lru_ttl_cache.has(two_key) == false);
+
+  entry_lru_ttl_cache.touch(one_key);
+
+  std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(0.5 * ttl_max_age_ms));
+
+  REQUIRE(entry_lru_ttl_cache.has(one_key) == true);
+
+  std::this_thread::sleep_for(std::chrono::duration<int, std::milli>(ttl_max_age_ms));
+
+  REQUIRE(entry_lru_ttl_cache.has(one_key) == false);
+
+  entry_lru_ttl_cache.insert(one_key, one_value, entry_lru_ttl_cache_t::duration_type(2 * ttl_max_age_ms));
+  REQUIRE(entry_lru_ttl_cache.has(one_key) == true);
+
+  std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(1.5 * ttl_max_age_ms));
+
+  REQUIRE(entry_lru_ttl_cache.has(one_key) == true);
+
+  std::this_thread::sleep_for(std::chrono::duration<int, std::milli>(ttl_max_age_ms));
+
+  REQUIRE(entry_lru_ttl_cache.has(one_key) == false);
+
+  // keys with different time-to-lives expire in the order of their end time
+  entry_lru_ttl_cache.insert(one_key, one_value, entry_lru_ttl_cache_t::duration_type(3 * ttl_max_age_ms));
+  entry_lru_ttl_cache.insert(two_key, two_value);
+
+  std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(1.5 * ttl_max_age_ms));
+
+  REQUIRE(entry_lru_ttl_cache.has(one_key) == true);
+  REQUIRE(entry_lru_ttl_cache.has(two_key) == false);
+
+  // a touched key keeps its own time-to-live
+  entry_lru_ttl_cache.touch(one_key);
+  entry_lru_ttl_cache.insert(two_key, two_value);
+
+  std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(1.5 * ttl_max_age_ms));
+
+  REQUIRE(entry_lru_ttl_cache.has(one_key) == true);
+  REQUIRE(entry_lru_ttl_cache.has(two_key) == false);
+  REQUIRE(entry_lru_ttl_cache.size() == 1);
+}
+
+TEST_CASE("entry-ttl distinct time-to-lives", "[entry-ttl]")
+{
+  using key_type = int;
+  using value_type = std::string;
+  using table = cpp_cache::policy::entry_table<key_type, value_type, cpp_cache::policy::entry_ttl_hook>;
+  using entry_ttl_cache_t = cpp_cache::cache<key_type, value_type,
+    cpp_cache::policy::entry_ttl<key_type, 1000, table, manual_clock>, cpp_cache::storage::entry<key_type, value_type>>;
+
+  manual_clock::advance_to(0);
+  entry_ttl_cache_t entry_ttl_cache;
+
+  // every key has a time-to-live of its own. they are inserted in reverse
+  // order of their end time and cover all levels of the timing wheel.
+  const key_type key_count = 1000;
+  auto max_age_ms = [](key_type key) { return static_cast<size_t>(key) * static_cast<size_t>(key) * 17 + 1; };
+  for (key_type key = key_count; key > 0; --key)
+    entry_ttl_cache.insert(key, std::to_string(key), max_age_ms(key));
+  REQUIRE(entry_ttl_cache.size() == static_cast<size_t>(key_count));
+
+  // every key is still cached right before its end time and has expired
+  // right after it
+  for (key_type key = 1; key <= key_count; ++key)
+  {
+    const manual_clock::rep end_ms = static_cast<manual_clock::rep>(max_age_ms(key));
+
+    manual_clock::advance_to(end_ms - 1);
+    REQUIRE(entry_ttl_cache.has(key) == true);
+    REQUIRE(entry_ttl_cache.size() == static_cast<size_t>(key_count - key + 1));
+
+    manual_clock::advance_to(end_ms + 1);
+    REQUIRE(entry_ttl_cache.has(key) == false);
+  }
+
+  REQUIRE(entry_ttl_cache.empty() == true);
+
+  // the key closest to exceeding its time-to-live is evicted first
+  entry_ttl_cache.insert(1, "one", static_cast<size_t>(100000));
+  entry_ttl_cache.insert(2, "two", static_cast<size_t>(300));
+  entry_ttl_cache.insert(3, "three", static_cast<size_t>(5000));
+
+  entry_ttl_cache.set_max_weight(2);
+  REQUIRE(entry_ttl_cache.has(2) == false);
+
+  entry_ttl_cache.set_max_weight(1);
+  REQUIRE(entry_ttl_cache.has(3) == false);
+  REQUIRE(entry_ttl_cache.has(1) == true);
+}
+
+TEST_CASE("entry value construction", "[entry-lru]")
+{
+  using key_type = int;
+  const size_t cache_size = 2;
+
+  cpp_cache::entry_lru_cache<key_type, counted_value, cache_size> entry_lru_cache;
+
+  // the value of a new key is copied into its entry exactly once
+  const counted_value one_value(1);
+  counted_value::copies = 0;
+  counted_value::assignments = 0;
+  REQUIRE(entry_lru_cache.insert(1, one_value) == true);
+  REQUIRE(counted_value::copies == 1);
+  REQUIRE(counted_value::assignments == 0);
+  REQUIRE(entry_lru_cache.get(1).value_ == 1);
+
+  // the value of a cached key is replaced
+  REQUIRE(entry_lru_cache.insert(1, counted_value(2)) == true);
+  REQUIRE(counted_value::copies == 1);
+  REQUIRE(counted_value::assignments == 1);
+  REQUIRE(entry_lru_cache.get(1).value_ == 2);
+
+  REQUIRE(entry_lru_cache.insert(2, counted_value(3)) == true);
+  REQUIRE(entry_lru_cache.insert(3, counted_value(4)) == true);
+  REQUIRE(entry_lru_cache.size() == cache_size);
+  REQUIRE(entry_lru_cache.has(1) == false);
+  REQUIRE(entry_lru_cache.get(2).value_ == 3);
+  REQUIRE(entry_lru_cache.get(3).value_ == 4);
+}
@@ -0,0 +1,107 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cpp-signals; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+
+#include <catch.hpp>
+
+#include <cpp-cache/gdsf-cache.h>
+
+TEST_CASE("gdsf", "[gdsf]")
+{
+  using key_type = int;
+  using value_type = std::string;
+  const size_t cache_size = 3;
+
+  using gdsf_cache_t = cpp_cache::gdsf_cache<key_type, value_type, cache_size>;
+  using cost_type = gdsf_cache_t::cost_type;
+  using object_size_type = gdsf_cache_t::object_size_type;
+  gdsf_cache_t gdsf_cache;
+
+  REQUIRE(gdsf_cache.max_size() == cache_size);
+  REQUIRE(gdsf_cache.empty() == true);
+  REQUIRE(gdsf_cache.inflation() == Approx(0));
+  REQUIRE(gdsf_cache.touch(1) == false);
+
+  // priorities 1, 10 and 0.1
+  gdsf_cache.insert(1, "1");
+  gdsf_cache.insert(2, "2", cost_type(10));
+  gdsf_cache.insert(3, "3", cost_type(1), object_size_type(10));
+  REQUIRE(gdsf_cache.size() == 3);
+
+  // the large and cheap key goes first
+  gdsf_cache.insert(4, "4");
+  REQUIRE(gdsf_cache.size() == 3);
+  REQUIRE(gdsf_cache.has(3) == false);
+  REQUIRE(gdsf_cache.inflation() == Approx(0.1));
+
+  // the priority of the new key has been inflated above the one of the old key
+  gdsf_cache.insert(5, "5");
+  REQUIRE(gdsf_cache.has(1) == false);
+  REQUIRE(gdsf_cache.has(4) == true);
+  REQUIRE(gdsf_cache.inflation() == Approx(1));
+
+  // using a key increases its frequency and therefore its priority to 3
+  REQUIRE(gdsf_cache.get(4) == "4");
+  gdsf_cache.insert(6, "6");
+  REQUIRE(gdsf_cache.has(5) == false);
+  REQUIRE(gdsf_cache.has(4) == true);
+  REQUIRE(gdsf_cache.inflation() == Approx(2));
+
+  // keys with the same priority are evicted in the order of their insertion
+  gdsf_cache.insert(7, "7");
+  REQUIRE(gdsf_cache.has(4) == false);
+  REQUIRE(gdsf_cache.has(6) == true);
+  REQUIRE(gdsf_cache.has(2) == true);
+  REQUIRE(gdsf_cache.inflation() == Approx(3));
+
+  // inserting a key again replaces its cost and size
+  gdsf_cache.insert(2, "2", cost_type(1), object_size_type(100));
+  gdsf_cache.insert(8, "8");
+  REQUIRE(gdsf_cache.has(6) == false);
+  REQUIRE(gdsf_cache.has(2) == true);
+  gdsf_cache.insert(9, "9");
+  REQUIRE(gdsf_cache.has(2) == false);
+  REQUIRE(gdsf_cache.has(7) == true);
+  REQUIRE(gdsf_cache.has(8) == true);
+
+  gdsf_cache.erase(7);
+  REQUIRE(gdsf_cache.size() == 2);
+  REQUIRE(gdsf_cache.has(7) == false);
+
+  // plain number literals are taken as the cost and the size as well
+  gdsf_cache.clear();
+  gdsf_cache.insert(1, "1", 10.0, 100);
+  gdsf_cache.insert(2, "2", 5);
+  gdsf_cache.insert(3, "3", 1, 2);
+  gdsf_cache.insert(4, "4");
+  REQUIRE(gdsf_cache.has(1) == false);
+  REQUIRE(gdsf_cache.inflation() == Approx(0.1));
+  gdsf_cache.insert(5, "5");
+  REQUIRE(gdsf_cache.has(3) == false);
+  REQUIRE(gdsf_cache.inflation() == Approx(0.5));
+  gdsf_cache.insert(6, "6");
+  REQUIRE(gdsf_cache.has(4) == false);
+  REQUIRE(gdsf_cache.has(2) == true);
+  REQUIRE(gdsf_cache.inflation() == Approx(1.1));
+
+  gdsf_cache.clear();
+  REQUIRE(gdsf_cache.empty() == true);
+  REQUIRE(gdsf_cache.inflation() == Approx(0));
+}
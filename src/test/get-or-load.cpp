@@ -0,0 +1,169 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cpp-signals; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <cpp-cache/lru-cache.h>
+
+namespace
+{
+  std::mutex unlocks_mutex;
+  std::condition_variable unlocks_cv;
+  size_t unlocks = 0;
+
+  // locking policy counting how often it has been unlocked so that a test can
+  // wait until a number of threads have looked up a key in the cache
+  class counting_mutex
+  {
+  public:
+    void lock() { mutex_.lock(); }
+
+    void unlock()
+    {
+      mutex_.unlock();
+
+      std::lock_guard<std::mutex> lock(unlocks_mutex);
+      ++unlocks;
+      unlocks_cv.notify_all();
+    }
+
+  private:
+    std::mutex mutex_;
+  };
+}
+
+TEST_CASE("get_or_load", "[get_or_load]")
+{
+  using key_type = int;
+  using value_type = std::string;
+  const size_t cache_size = 2;
+
+  const key_type one_key = 1;
+  const value_type one_value = "one";
+  const key_type two_key = 2;
+  const value_type two_value = "two";
+
+  cpp_cache::lru_cache<key_type, value_type, cache_size, cpp_cache::storage::map<key_type, value_type>, std::mutex> lru_cache;
+
+  std::atomic<size_t> loads(0);
+  auto loader = [&loads, one_key, one_value, two_value](const key_type& key)
+  {
+    ++loads;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    return key == one_key ? one_value : two_value;
+  };
+
+  SECTION("single thread")
+  {
+    REQUIRE(lru_cache.get_or_load(one_key, loader) == one_value);
+    REQUIRE(loads == 1);
+    REQUIRE(lru_cache.has(one_key) == true);
+
+    // the second time the value is cached
+    REQUIRE(lru_cache.get_or_load(one_key, loader) == one_value);
+    REQUIRE(loads == 1);
+
+    lru_cache.insert(two_key, two_value);
+    REQUIRE(lru_cache.get_or_load(two_key, loader) == two_value);
+    REQUIRE(loads == 1);
+  }
+
+  SECTION("concurrent misses")
+  {
+    const size_t thread_count = 16;
+    std::vector<value_type> values(thread_count);
+    std::vector<std::thread> threads;
+
+    for (size_t index = 0; index < thread_count; ++index)
+      threads.emplace_back([&lru_cache, &loader, &values, index, one_key]() { values[index] = lru_cache.get_or_load(one_key, loader); });
+
+    for (auto& thread : threads)
+      thread.join();
+
+    // only one thread had to load the value
+    REQUIRE(loads == 1);
+    for (const auto& value : values)
+      REQUIRE(value == one_value);
+
+    REQUIRE(lru_cache.get(one_key) == one_value);
+  }
+
+  SECTION("failed load")
+  {
+    const size_t thread_count = 8;
+    std::vector<int> failures(thread_count, 0);
+    std::vector<std::thread> threads;
+
+    cpp_cache::lru_cache<key_type, value_type, cache_size, cpp_cache::storage::map<key_type, value_type>, counting_mutex> counting_cache;
+    {
+      std::lock_guard<std::mutex> lock(unlocks_mutex);
+      unlocks = 0;
+    }
+
+    // every thread unlocks the cache once before waiting for the load (or
+    // before loading) so the load only fails once all threads are waiting
+    auto failing_loader = [&loads, thread_count](const key_type&) -> value_type
+    {
+      ++loads;
+
+      std::unique_lock<std::mutex> lock(unlocks_mutex);
+      unlocks_cv.wait(lock, [thread_count]() { return unlocks >= thread_count; });
+
+      throw std::runtime_error("failed to load");
+    };
+
+    for (size_t index = 0; index < thread_count; ++index)
+    {
+      threads.emplace_back([&counting_cache, &failing_loader, &failures, index, one_key]()
+      {
+        try
+        {
+          counting_cache.get_or_load(one_key, failing_loader);
+        }
+        catch (std::runtime_error&)
+        {
+          failures[index] = 1;
+        }
+      });
+    }
+
+    for (auto& thread : threads)
+      thread.join();
+
+    // every waiting thread gets the exception and nothing is cached
+    for (const auto& failure : failures)
+      REQUIRE(failure == 1);
+    REQUIRE(loads == 1);
+    REQUIRE(counting_cache.has(one_key) == false);
+
+    // the next call loads again
+    REQUIRE(counting_cache.get_or_load(one_key, loader) == one_value);
+    REQUIRE(loads == 2);
+    REQUIRE(counting_cache.has(one_key) == true);
+  }
+}
@@ -0,0 +1,111 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cpp-signals; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+
+#include <catch.hpp>
+
+#include <cpp-cache/lirs-cache.h>
+#include <cpp-cache/lru-cache.h>
+
+TEST_CASE("lirs", "[lirs]")
+{
+  using key_type = int;
+  using value_type = std::string;
+
+  SECTION("basics")
+  {
+    // one key is reserved for HIR keys
+    const size_t cache_size = 3;
+
+    cpp_cache::lirs_cache<key_type, value_type, cache_size> lirs_cache;
+
+    REQUIRE(lirs_cache.max_size() == cache_size);
+    REQUIRE(lirs_cache.empty() == true);
+    REQUIRE(lirs_cache.touch(1) == false);
+
+    // the first two keys become LIR keys and the third a HIR key
+    lirs_cache.insert(1, "1");
+    lirs_cache.insert(2, "2");
+    lirs_cache.insert(3, "3");
+    REQUIRE(lirs_cache.size() == 3);
+    REQUIRE(lirs_cache.get(1) == "1");
+
+    // only the HIR key is evicted
+    lirs_cache.insert(4, "4");
+    REQUIRE(lirs_cache.size() == 3);
+    REQUIRE(lirs_cache.has(1) == true);
+    REQUIRE(lirs_cache.has(2) == true);
+    REQUIRE(lirs_cache.has(3) == false);
+    REQUIRE(lirs_cache.has(4) == true);
+
+    // three is still in the stack so using it again turns it into a LIR key
+    // and two (at the bottom of the stack) into a HIR key
+    lirs_cache.insert(3, "3");
+    REQUIRE(lirs_cache.has(3) == true);
+    REQUIRE(lirs_cache.has(4) == false);
+
+    lirs_cache.insert(5, "5");
+    REQUIRE(lirs_cache.has(1) == true);
+    REQUIRE(lirs_cache.has(2) == false);
+    REQUIRE(lirs_cache.has(3) == true);
+    REQUIRE(lirs_cache.has(5) == true);
+
+    lirs_cache.erase(1);
+    REQUIRE(lirs_cache.size() == 2);
+    REQUIRE(lirs_cache.has(1) == false);
+
+    lirs_cache.clear();
+    REQUIRE(lirs_cache.empty() == true);
+    REQUIRE(lirs_cache.has(3) == false);
+  }
+
+  SECTION("loop")
+  {
+    const size_t cache_size = 10;
+    const key_type loop_size = 11;
+    const size_t loops = 10;
+
+    cpp_cache::lirs_cache<key_type, value_type, cache_size> lirs_cache;
+    cpp_cache::lru_cache<key_type, value_type, cache_size> lru_cache;
+
+    size_t lirs_hits = 0;
+    size_t lru_hits = 0;
+    for (size_t loop = 0; loop < loops; ++loop)
+    {
+      for (key_type key = 0; key < loop_size; ++key)
+      {
+        if (lirs_cache.touch(key))
+          ++lirs_hits;
+        else
+          lirs_cache.insert(key, std::to_string(key));
+
+        if (lru_cache.touch(key))
+          ++lru_hits;
+        else
+          lru_cache.insert(key, std::to_string(key));
+      }
+    }
+
+    // a loop slightly larger than the cache never hits with LRU while LIRS
+    // keeps its LIR keys
+    REQUIRE(lru_hits == 0);
+    REQUIRE(lirs_hits >= (loops - 1) * (cache_size - 1));
+  }
+}
@@ -0,0 +1,98 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cpp-signals; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+
+#include <catch.hpp>
+
+#include <cpp-cache/lru-k-cache.h>
+
+TEST_CASE("lru_k", "[lru_k]")
+{
+  using key_type = int;
+  using value_type = std::string;
+  const size_t cache_size = 3;
+
+  SECTION("lru-2")
+  {
+    cpp_cache::lru_k_cache<key_type, value_type, cache_size> lru_k_cache;
+
+    REQUIRE(lru_k_cache.max_size() == cache_size);
+    REQUIRE(lru_k_cache.empty() == true);
+    REQUIRE(lru_k_cache.touch(1) == false);
+
+    lru_k_cache.insert(1, "1");
+    lru_k_cache.insert(2, "2");
+    lru_k_cache.insert(3, "3");
+    REQUIRE(lru_k_cache.get(1) == "1");
+    REQUIRE(lru_k_cache.touch(2) == true);
+
+    // keys only used once are evicted before the keys used twice
+    lru_k_cache.insert(4, "4");
+    REQUIRE(lru_k_cache.has(3) == false);
+    lru_k_cache.insert(5, "5");
+    REQUIRE(lru_k_cache.has(4) == false);
+    REQUIRE(lru_k_cache.has(1) == true);
+    REQUIRE(lru_k_cache.has(2) == true);
+    REQUIRE(lru_k_cache.size() == cache_size);
+
+    // an evicted key keeps its history and counts as used twice
+    lru_k_cache.insert(3, "3");
+    REQUIRE(lru_k_cache.has(5) == false);
+
+    // the key with the oldest second to last use goes first
+    lru_k_cache.insert(6, "6");
+    REQUIRE(lru_k_cache.has(1) == false);
+    REQUIRE(lru_k_cache.has(2) == true);
+    REQUIRE(lru_k_cache.has(3) == true);
+
+    lru_k_cache.erase(2);
+    REQUIRE(lru_k_cache.size() == 2);
+    REQUIRE(lru_k_cache.has(2) == false);
+
+    lru_k_cache.clear();
+    REQUIRE(lru_k_cache.empty() == true);
+    REQUIRE(lru_k_cache.has(3) == false);
+  }
+
+  SECTION("correlated period")
+  {
+    using policy = cpp_cache::policy::lru_k<key_type, cache_size, 2, 2>;
+    cpp_cache::cache<key_type, value_type, policy, cpp_cache::storage::map<key_type, value_type>> lru_k_cache;
+
+    // a burst of uses only counts as a single use
+    lru_k_cache.insert(1, "1");
+    REQUIRE(lru_k_cache.touch(1) == true);
+    lru_k_cache.insert(2, "2");
+    lru_k_cache.insert(3, "3");
+
+    // the keys used within the correlated period can't be evicted
+    lru_k_cache.insert(4, "4");
+    REQUIRE(lru_k_cache.has(1) == false);
+    REQUIRE(lru_k_cache.has(2) == true);
+    REQUIRE(lru_k_cache.has(3) == true);
+
+    // once their correlated period is over keys are evicted as usual
+    lru_k_cache.insert(5, "5");
+    REQUIRE(lru_k_cache.has(2) == false);
+    lru_k_cache.insert(6, "6");
+    REQUIRE(lru_k_cache.has(3) == false);
+    REQUIRE(lru_k_cache.size() == cache_size);
+  }
+}
@@ -52,6 +52,7 @@ TEST_CASE("lru", "[lru]")
   REQUIRE(lru_cache.try_get(two_key, tmp) == false);
   REQUIRE(lru_cache.try_get(three_key, tmp) == false);
   REQUIRE(lru_cache.try_get(four_key, tmp) == false);
+  REQUIRE(lru_cache.find(one_key) == nullptr);
 
   try
   {
@@ -131,4 +132,14 @@ TEST_CASE("lru", "[lru]")
   REQUIRE(lru_cache.has(three_key) == false);
   REQUIRE(lru_cache.has(two_key) == true);
   REQUIRE(lru_cache.has(one_key) == false);
+
+  // finding a key touches it just like getting it
+  REQUIRE(lru_cache.find(one_key) == nullptr);
+  REQUIRE(lru_cache.find(four_key) != nullptr);
+  REQUIRE(*lru_cache.find(four_key) == four_value);
+
+  lru_cache.insert(one_key, one_value);
+  REQUIRE(lru_cache.has(four_key) == true);
+  REQUIRE(lru_cache.has(two_key) == false);
+  REQUIRE(lru_cache.has(one_key) == true);
 }
@@ -0,0 +1,105 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cpp-signals; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+
+#include <catch.hpp>
+
+#include <cpp-cache/s3fifo-cache.h>
+
+TEST_CASE("s3fifo", "[s3fifo]")
+{
+  using key_type = int;
+  using value_type = std::string;
+
+  SECTION("small queue")
+  {
+    // the small queue holds a tenth of the keys
+    const size_t cache_size = 10;
+
+    cpp_cache::s3fifo_cache<key_type, value_type, cache_size> s3fifo_cache;
+
+    REQUIRE(s3fifo_cache.max_size() == cache_size);
+    REQUIRE(s3fifo_cache.empty() == true);
+    REQUIRE(s3fifo_cache.touch(1) == false);
+
+    for (key_type key = 1; key <= 10; ++key)
+      s3fifo_cache.insert(key, std::to_string(key));
+    REQUIRE(s3fifo_cache.size() == 10);
+
+    // the touched key is moved to the main queue instead of being evicted
+    REQUIRE(s3fifo_cache.get(1) == "1");
+    s3fifo_cache.insert(11, "11");
+    REQUIRE(s3fifo_cache.size() == 10);
+    REQUIRE(s3fifo_cache.has(1) == true);
+    REQUIRE(s3fifo_cache.has(2) == false);
+    REQUIRE(s3fifo_cache.has(11) == true);
+
+    // the evicted key is remembered and goes straight into the main queue
+    s3fifo_cache.insert(2, "2");
+    REQUIRE(s3fifo_cache.has(2) == true);
+    REQUIRE(s3fifo_cache.has(3) == false);
+
+    // keys which are only inserted once never make it into the main queue
+    for (key_type key = 12; key <= 19; ++key)
+      s3fifo_cache.insert(key, std::to_string(key));
+    REQUIRE(s3fifo_cache.size() == 10);
+    REQUIRE(s3fifo_cache.has(1) == true);
+    REQUIRE(s3fifo_cache.has(2) == true);
+    REQUIRE(s3fifo_cache.has(11) == false);
+    REQUIRE(s3fifo_cache.has(19) == true);
+
+    s3fifo_cache.erase(1);
+    REQUIRE(s3fifo_cache.size() == 9);
+    REQUIRE(s3fifo_cache.has(1) == false);
+
+    s3fifo_cache.clear();
+    REQUIRE(s3fifo_cache.empty() == true);
+    REQUIRE(s3fifo_cache.has(2) == false);
+  }
+
+  SECTION("main queue")
+  {
+    const size_t cache_size = 2;
+
+    cpp_cache::s3fifo_cache<key_type, value_type, cache_size> s3fifo_cache;
+
+    s3fifo_cache.insert(1, "1");
+    REQUIRE(s3fifo_cache.touch(1) == true);
+    s3fifo_cache.insert(2, "2");
+    s3fifo_cache.insert(3, "3");
+    REQUIRE(s3fifo_cache.has(1) == true);
+    REQUIRE(s3fifo_cache.has(2) == false);
+    REQUIRE(s3fifo_cache.has(3) == true);
+
+    // two is remembered and evicts three from the small queue
+    s3fifo_cache.insert(2, "2");
+    REQUIRE(s3fifo_cache.has(1) == true);
+    REQUIRE(s3fifo_cache.has(2) == true);
+    REQUIRE(s3fifo_cache.has(3) == false);
+
+    // with the small queue empty the main queue has to evict a key. one has
+    // been touched so it is reinserted and two is evicted instead
+    REQUIRE(s3fifo_cache.touch(1) == true);
+    s3fifo_cache.insert(4, "4");
+    REQUIRE(s3fifo_cache.has(1) == true);
+    REQUIRE(s3fifo_cache.has(2) == false);
+    REQUIRE(s3fifo_cache.has(4) == true);
+  }
+}
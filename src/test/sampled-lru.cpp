@@ -0,0 +1,94 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cpp-signals; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+
+#include <catch.hpp>
+
+#include <cpp-cache/sampled-lru-cache.h>
+
+TEST_CASE("sampled_lru", "[sampled_lru]")
+{
+  using key_type = int;
+  using value_type = std::string;
+
+  SECTION("exact")
+  {
+    // caches which aren't larger than the number of samples behave like LRU
+    const size_t cache_size = 4;
+
+    cpp_cache::sampled_lru_cache<key_type, value_type, cache_size> lru_cache;
+
+    REQUIRE(lru_cache.max_size() == cache_size);
+    REQUIRE(lru_cache.empty() == true);
+    REQUIRE(lru_cache.touch(1) == false);
+
+    for (key_type key = 1; key <= 4; ++key)
+      lru_cache.insert(key, std::to_string(key));
+    REQUIRE(lru_cache.size() == 4);
+
+    REQUIRE(lru_cache.get(1) == "1");
+    lru_cache.insert(5, "5");
+    REQUIRE(lru_cache.size() == 4);
+    REQUIRE(lru_cache.has(1) == true);
+    REQUIRE(lru_cache.has(2) == false);
+
+    lru_cache.insert(6, "6");
+    REQUIRE(lru_cache.has(1) == true);
+    REQUIRE(lru_cache.has(3) == false);
+    REQUIRE(lru_cache.has(4) == true);
+
+    // keys erased after they have been sampled are skipped
+    lru_cache.erase(4);
+    REQUIRE(lru_cache.size() == 3);
+    lru_cache.insert(7, "7");
+    lru_cache.insert(8, "8");
+    REQUIRE(lru_cache.size() == 4);
+    REQUIRE(lru_cache.has(1) == false);
+    REQUIRE(lru_cache.has(5) == true);
+
+    lru_cache.clear();
+    REQUIRE(lru_cache.empty() == true);
+    REQUIRE(lru_cache.has(5) == false);
+  }
+
+  SECTION("sampled")
+  {
+    const size_t cache_size = 100;
+
+    cpp_cache::sampled_lru_cache<key_type, value_type, cache_size> lru_cache;
+
+    // the first ten keys are touched after every insert so they are always
+    // among the most recently used keys
+    for (key_type key = 0; key < 1000; ++key)
+    {
+      lru_cache.insert(key, std::to_string(key));
+      for (key_type hot_key = 0; hot_key < 10 && hot_key <= key; ++hot_key)
+        lru_cache.touch(hot_key);
+    }
+
+    REQUIRE(lru_cache.size() == cache_size);
+    REQUIRE(lru_cache.has(999) == true);
+    for (key_type hot_key = 0; hot_key < 10; ++hot_key)
+      REQUIRE(lru_cache.has(hot_key) == true);
+
+    // keys which have never been touched age out
+    REQUIRE(lru_cache.has(10) == false);
+  }
+}
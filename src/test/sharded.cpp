@@ -0,0 +1,210 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cpp-signals; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <cpp-cache/sharded-cache.h>
+#include <cpp-cache/policy/dynamic.h>
+#include <cpp-cache/policy/lru.h>
+#include <cpp-cache/policy/ttl.h>
+#include <cpp-cache/storage/map.h>
+
+namespace
+{
+  struct string_weigher
+  {
+    size_t operator()(int, const std::string& value) const { return value.size(); }
+  };
+}
+
+TEST_CASE("sharded", "[sharded]")
+{
+  using key_type = int;
+  using value_type = std::string;
+  const size_t shards = 4;
+  const size_t cache_size = 16;
+  const size_t shard_size = cpp_cache::shard_size(cache_size, shards);
+
+  const key_type one_key = 1;
+  const value_type one_value = "one";
+  const key_type two_key = 2;
+  const value_type two_value = "two";
+  const key_type three_key = 3;
+
+  using sharded_cache_t = cpp_cache::sharded_cache<key_type, value_type, cpp_cache::policy::lru<key_type, shard_size>, cpp_cache::storage::map<key_type, value_type>, std::mutex, shards>;
+  sharded_cache_t sharded_cache;
+
+  REQUIRE(sharded_cache_t::shard_count() == shards);
+  REQUIRE(sharded_cache.max_size() == cache_size);
+  REQUIRE(sharded_cache.size() == 0);
+  REQUIRE(sharded_cache.empty() == true);
+
+  REQUIRE(sharded_cache.has(one_key) == false);
+  REQUIRE(sharded_cache.has(two_key) == false);
+
+  value_type tmp;
+  REQUIRE(sharded_cache.try_get(one_key, tmp) == false);
+
+  try
+  {
+    sharded_cache.get(one_key);
+    REQUIRE(false);
+  }
+  catch (std::out_of_range&) { REQUIRE(true); }
+  catch (...) { REQUIRE(false); }
+
+  sharded_cache.insert(one_key, one_value);
+  REQUIRE(sharded_cache.has(one_key) == true);
+  REQUIRE(sharded_cache.try_get(one_key, tmp) == true);
+  REQUIRE(tmp == one_value);
+  REQUIRE(sharded_cache.get(one_key) == one_value);
+  REQUIRE(sharded_cache.touch(one_key) == true);
+  REQUIRE(sharded_cache.size() == 1);
+  REQUIRE(sharded_cache.empty() == false);
+
+  sharded_cache.insert(two_key, two_value);
+  REQUIRE(sharded_cache.has(two_key) == true);
+  REQUIRE(sharded_cache.get(two_key) == two_value);
+  REQUIRE(sharded_cache.size() == 2);
+
+  sharded_cache.erase(three_key);
+  REQUIRE(sharded_cache.size() == 2);
+
+  sharded_cache.erase(one_key);
+  REQUIRE(sharded_cache.size() == 1);
+  REQUIRE(sharded_cache.has(one_key) == false);
+  REQUIRE(sharded_cache.has(two_key) == true);
+
+  sharded_cache.clear();
+  REQUIRE(sharded_cache.size() == 0);
+  REQUIRE(sharded_cache.empty() == true);
+
+  // no shard can ever hold more than its share of the capacity
+  for (key_type key = 0; key < 10 * static_cast<key_type>(cache_size); ++key)
+    sharded_cache.insert(key, std::to_string(key));
+  REQUIRE(sharded_cache.size() <= sharded_cache.max_size());
+  REQUIRE(sharded_cache.empty() == false);
+
+  sharded_cache.clear();
+
+  // concurrent access from multiple threads
+  const size_t thread_count = 8;
+  const key_type keys_per_thread = 1000;
+
+  std::atomic<bool> mismatch(false);
+  std::vector<std::thread> threads;
+  for (size_t thread = 0; thread < thread_count; ++thread)
+  {
+    threads.emplace_back([&sharded_cache, &mismatch, thread, keys_per_thread]()
+    {
+      const key_type offset = static_cast<key_type>(thread) * keys_per_thread;
+      for (key_type key = offset; key < offset + keys_per_thread; ++key)
+      {
+        sharded_cache.insert(key, std::to_string(key));
+
+        value_type value;
+        if (sharded_cache.try_get(key, value) && value != std::to_string(key))
+          mismatch = true;
+      }
+    });
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+
+  REQUIRE(mismatch == false);
+  REQUIRE(sharded_cache.size() <= sharded_cache.max_size());
+  REQUIRE(sharded_cache.size() > 0);
+}
+
+TEST_CASE("sharded dynamic", "[sharded]")
+{
+  using key_type = int;
+  using value_type = std::string;
+  const size_t shards = 4;
+  const size_t shard_size = 4;
+  const size_t ttl_max_age_ms = 200;
+
+  using sharded_cache_t = cpp_cache::sharded_cache<key_type, value_type,
+    cpp_cache::policy::lru<key_type, cpp_cache::policy::dynamic, cpp_cache::policy::ttl<key_type, cpp_cache::policy::dynamic>>,
+    cpp_cache::storage::map<key_type, value_type>, std::mutex, shards>;
+  sharded_cache_t sharded_cache(sharded_cache_t::hasher(), shard_size, ttl_max_age_ms);
+
+  REQUIRE(sharded_cache.max_size() == shards * shard_size);
+
+  for (key_type key = 0; key < 10 * static_cast<key_type>(shards * shard_size); ++key)
+    sharded_cache.insert(key, std::to_string(key));
+  REQUIRE(sharded_cache.size() <= shards * shard_size);
+  REQUIRE(sharded_cache.size() > shard_size);
+
+  // every shard is resized
+  sharded_cache.resize(1);
+  REQUIRE(sharded_cache.max_size() == shards);
+  REQUIRE(sharded_cache.size() <= shards);
+
+  // every shard uses the new default maximum age for new keys
+  sharded_cache.clear();
+  sharded_cache.set_default_max_age(20 * ttl_max_age_ms);
+  for (key_type key = 0; key < static_cast<key_type>(shards); ++key)
+    sharded_cache.insert(key, std::to_string(key));
+
+  std::this_thread::sleep_for(std::chrono::duration<int, std::milli>(2 * ttl_max_age_ms));
+  REQUIRE(sharded_cache.empty() == false);
+}
+
+TEST_CASE("sharded weight", "[sharded]")
+{
+  using key_type = int;
+  using value_type = std::string;
+  const size_t shards = 4;
+  const size_t shard_size = 100;
+  const size_t max_weight = 4 * 10 + 2;
+
+  using sharded_cache_t = cpp_cache::sharded_cache<key_type, value_type, cpp_cache::policy::lru<key_type, shard_size>,
+    cpp_cache::storage::map<key_type, value_type>, std::mutex, shards, std::hash<key_type>, string_weigher>;
+  sharded_cache_t sharded_cache;
+
+  REQUIRE(sharded_cache.max_weight() == std::numeric_limits<sharded_cache_t::weight_type>::max());
+  REQUIRE(sharded_cache.weight() == 0);
+
+  // the maximum weight is split across all shards
+  sharded_cache.set_max_weight(max_weight);
+  REQUIRE(sharded_cache.max_weight() == max_weight);
+
+  // a value heavier than the share of its shard can't be cached
+  REQUIRE(sharded_cache.insert(0, std::string(max_weight, 'x')) == false);
+  REQUIRE(sharded_cache.weight() == 0);
+
+  for (key_type key = 0; key < 100; ++key)
+    REQUIRE(sharded_cache.insert(key, std::string(5, 'x')) == true);
+  REQUIRE(sharded_cache.weight() <= max_weight);
+  REQUIRE(sharded_cache.weight() == 5 * sharded_cache.size());
+  REQUIRE(sharded_cache.size() > 0);
+
+  sharded_cache.clear();
+  REQUIRE(sharded_cache.weight() == 0);
+}
@@ -0,0 +1,124 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cpp-signals; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <cpp-cache/fifo-cache.h>
+#include <cpp-cache/lru-cache.h>
+
+namespace
+{
+  // custom caching policy which doesn't opt in to shared reads
+  template<class Key>
+  class custom_policy : public cpp_cache::policy::none<Key, size_t>
+  { };
+}
+
+TEST_CASE("shared_locking", "[shared_locking]")
+{
+  using key_type = int;
+  using value_type = std::string;
+  const size_t cache_size = 16;
+
+  using fifo_cache = cpp_cache::fifo_cache<key_type, value_type, cache_size, cpp_cache::storage::map<key_type, value_type>, cpp_cache::shared_locking>;
+  using lru_cache = cpp_cache::lru_cache<key_type, value_type, cache_size, cpp_cache::storage::map<key_type, value_type>, cpp_cache::shared_locking>;
+
+  SECTION("shared reads")
+  {
+    // fifo doesn't change on reads whereas lru moves every key it reads
+    REQUIRE(cpp_cache::detail::shared_reads<fifo_cache::caching_policy>::value == true);
+    REQUIRE(cpp_cache::detail::shared_reads<lru_cache::caching_policy>::value == false);
+    // custom caching policies have to opt in to shared reads
+    using none_policy = cpp_cache::policy::none<key_type, size_t>;
+    using custom_fifo_policy = cpp_cache::policy::fifo<key_type, cache_size, custom_policy<key_type>>;
+    REQUIRE(cpp_cache::detail::shared_reads<none_policy>::value == true);
+    REQUIRE(cpp_cache::detail::shared_reads<custom_policy<key_type>>::value == false);
+    REQUIRE(cpp_cache::detail::shared_reads<custom_fifo_policy>::value == false);
+    REQUIRE(cpp_cache::detail::shared_lockable<cpp_cache::shared_locking>::value == true);
+    REQUIRE(cpp_cache::detail::shared_lockable<std::mutex>::value == false);
+  }
+
+  SECTION("multiple readers")
+  {
+    cpp_cache::shared_locking lock;
+    lock.lock_shared();
+
+    // another reader doesn't have to wait for the first one
+    std::atomic<bool> read(false);
+    std::thread reader([&lock, &read]() { lock.lock_shared(); read = true; lock.unlock_shared(); });
+    reader.join();
+    REQUIRE(read == true);
+
+    // a writer has to wait for all readers
+    std::atomic<bool> written(false);
+    std::thread writer([&lock, &written]() { lock.lock(); written = true; lock.unlock(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    REQUIRE(written == false);
+
+    lock.unlock_shared();
+    writer.join();
+    REQUIRE(written == true);
+  }
+
+  SECTION("concurrent access")
+  {
+    fifo_cache cache;
+    for (key_type key = 0; key < static_cast<key_type>(cache_size); ++key)
+      cache.insert(key, std::to_string(key));
+
+    const size_t reader_count = 8;
+    const size_t iterations = 1000;
+    std::atomic<size_t> hits(0);
+    std::vector<std::thread> threads;
+
+    for (size_t index = 0; index < reader_count; ++index)
+    {
+      threads.emplace_back([&cache, &hits, cache_size, iterations]()
+      {
+        value_type value;
+        for (size_t iteration = 0; iteration < iterations; ++iteration)
+        {
+          if (cache.try_get(static_cast<key_type>(iteration % cache_size), value))
+            ++hits;
+        }
+      });
+    }
+
+    // overwrite the cached keys while they are being read
+    threads.emplace_back([&cache, cache_size, iterations]()
+    {
+      for (size_t iteration = 0; iteration < iterations; ++iteration)
+        cache.insert(static_cast<key_type>(iteration % cache_size), std::to_string(iteration));
+    });
+
+    for (auto& thread : threads)
+      thread.join();
+
+    // none of the keys are ever evicted
+    REQUIRE(hits == reader_count * iterations);
+    REQUIRE(cache.size() == cache_size);
+  }
+}
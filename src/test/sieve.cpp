@@ -0,0 +1,104 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cpp-signals; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+
+#include <catch.hpp>
+
+#include <cpp-cache/sieve-cache.h>
+
+TEST_CASE("sieve", "[sieve]")
+{
+  using key_type = int;
+  using value_type = std::string;
+  const size_t cache_size = 3;
+
+  const key_type one_key = 1;
+  const value_type one_value = "one";
+  const key_type two_key = 2;
+  const value_type two_value = "two";
+  const key_type three_key = 3;
+  const value_type three_value = "three";
+  const key_type four_key = 4;
+  const value_type four_value = "four";
+  const key_type five_key = 5;
+  const value_type five_value = "five";
+
+  cpp_cache::sieve_cache<key_type, value_type, cache_size> sieve_cache;
+
+  REQUIRE(sieve_cache.max_size() == cache_size);
+  REQUIRE(sieve_cache.size() == 0);
+  REQUIRE(sieve_cache.empty() == true);
+  REQUIRE(sieve_cache.has(one_key) == false);
+  REQUIRE(sieve_cache.touch(one_key) == false);
+
+  sieve_cache.insert(one_key, one_value);
+  sieve_cache.insert(two_key, two_value);
+  sieve_cache.insert(three_key, three_value);
+  REQUIRE(sieve_cache.size() == 3);
+  REQUIRE(sieve_cache.has(one_key) == true);
+  REQUIRE(sieve_cache.has(two_key) == true);
+  REQUIRE(sieve_cache.has(three_key) == true);
+
+  // without any visits the oldest key is evicted
+  sieve_cache.insert(four_key, four_value);
+  REQUIRE(sieve_cache.size() == 3);
+  REQUIRE(sieve_cache.has(one_key) == false);
+  REQUIRE(sieve_cache.has(two_key) == true);
+
+  // the visited key stays in place and the next older key is evicted
+  REQUIRE(sieve_cache.get(two_key) == two_value);
+  sieve_cache.insert(five_key, five_value);
+  REQUIRE(sieve_cache.has(two_key) == true);
+  REQUIRE(sieve_cache.has(three_key) == false);
+  REQUIRE(sieve_cache.has(four_key) == true);
+  REQUIRE(sieve_cache.has(five_key) == true);
+
+  // the hand continues from where it stopped instead of starting over at two
+  // which is the oldest key but lost its visited mark
+  REQUIRE(sieve_cache.touch(five_key) == true);
+  sieve_cache.insert(one_key, one_value);
+  REQUIRE(sieve_cache.has(two_key) == true);
+  REQUIRE(sieve_cache.has(four_key) == false);
+  REQUIRE(sieve_cache.has(five_key) == true);
+  REQUIRE(sieve_cache.has(one_key) == true);
+
+  // the hand clears the visited mark of five and reaches the newest key
+  sieve_cache.insert(three_key, three_value);
+  REQUIRE(sieve_cache.has(two_key) == true);
+  REQUIRE(sieve_cache.has(five_key) == true);
+  REQUIRE(sieve_cache.has(one_key) == false);
+  REQUIRE(sieve_cache.has(three_key) == true);
+
+  // the hand wraps around to the oldest key
+  sieve_cache.insert(four_key, four_value);
+  REQUIRE(sieve_cache.has(two_key) == false);
+  REQUIRE(sieve_cache.has(five_key) == true);
+  REQUIRE(sieve_cache.has(three_key) == true);
+  REQUIRE(sieve_cache.has(four_key) == true);
+
+  sieve_cache.erase(five_key);
+  REQUIRE(sieve_cache.size() == 2);
+  REQUIRE(sieve_cache.has(five_key) == false);
+
+  sieve_cache.clear();
+  REQUIRE(sieve_cache.size() == 0);
+  REQUIRE(sieve_cache.empty() == true);
+  REQUIRE(sieve_cache.has(one_key) == false);
+}
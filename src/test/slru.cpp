@@ -0,0 +1,75 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cpp-signals; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+
+#include <catch.hpp>
+
+#include <cpp-cache/slru-cache.h>
+
+TEST_CASE("slru", "[slru]")
+{
+  using key_type = int;
+  using value_type = std::string;
+  const size_t cache_size = 4;
+
+  cpp_cache::slru_cache<key_type, value_type, cache_size> slru_cache;
+
+  REQUIRE(slru_cache.max_size() == cache_size);
+  REQUIRE(slru_cache.protected_size() == 3);
+  REQUIRE(slru_cache.empty() == true);
+  REQUIRE(slru_cache.touch(1) == false);
+
+  for (key_type key = 1; key <= 4; ++key)
+    slru_cache.insert(key, std::to_string(key));
+  REQUIRE(slru_cache.size() == 4);
+
+  // one and two are promoted to the protected segment
+  REQUIRE(slru_cache.get(1) == "1");
+  REQUIRE(slru_cache.get(2) == "2");
+
+  // a scan only evicts keys on probation
+  for (key_type key = 5; key <= 20; ++key)
+    slru_cache.insert(key, std::to_string(key));
+  REQUIRE(slru_cache.size() == 4);
+  REQUIRE(slru_cache.has(1) == true);
+  REQUIRE(slru_cache.has(2) == true);
+  REQUIRE(slru_cache.has(3) == false);
+  REQUIRE(slru_cache.has(18) == false);
+  REQUIRE(slru_cache.has(19) == true);
+  REQUIRE(slru_cache.has(20) == true);
+
+  // the protected segment is full so its least recently used key is demoted
+  REQUIRE(slru_cache.touch(20) == true);
+  REQUIRE(slru_cache.touch(19) == true);
+  slru_cache.insert(21, "21");
+  REQUIRE(slru_cache.has(1) == false);
+  REQUIRE(slru_cache.has(2) == true);
+  REQUIRE(slru_cache.has(19) == true);
+  REQUIRE(slru_cache.has(20) == true);
+  REQUIRE(slru_cache.has(21) == true);
+
+  slru_cache.erase(2);
+  REQUIRE(slru_cache.size() == 3);
+  REQUIRE(slru_cache.has(2) == false);
+
+  slru_cache.clear();
+  REQUIRE(slru_cache.empty() == true);
+  REQUIRE(slru_cache.has(21) == false);
+}
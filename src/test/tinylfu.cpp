@@ -0,0 +1,144 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cpp-signals; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <catch.hpp>
+
+#include <cpp-cache/tinylfu-cache.h>
+
+TEST_CASE("tinylfu", "[tinylfu]")
+{
+  using key_type = int;
+  using value_type = std::string;
+  const size_t cache_size = 2;
+
+  const key_type one_key = 1;
+  const value_type one_value = "one";
+  const key_type two_key = 2;
+  const value_type two_value = "two";
+  const key_type three_key = 3;
+  const value_type three_value = "three";
+  const key_type four_key = 4;
+  const value_type four_value = "four";
+
+  cpp_cache::tinylfu_cache<key_type, value_type, cache_size> tinylfu_cache;
+
+  REQUIRE(tinylfu_cache.max_size() == cache_size);
+  REQUIRE(tinylfu_cache.size() == 0);
+  REQUIRE(tinylfu_cache.empty() == true);
+
+  REQUIRE(tinylfu_cache.has(one_key) == false);
+  REQUIRE(tinylfu_cache.has(two_key) == false);
+  REQUIRE(tinylfu_cache.has(three_key) == false);
+  REQUIRE(tinylfu_cache.has(four_key) == false);
+
+  value_type tmp;
+  REQUIRE(tinylfu_cache.try_get(one_key, tmp) == false);
+  REQUIRE(tinylfu_cache.try_get(two_key, tmp) == false);
+  REQUIRE(tinylfu_cache.try_get(three_key, tmp) == false);
+  REQUIRE(tinylfu_cache.try_get(four_key, tmp) == false);
+
+  try
+  {
+    tinylfu_cache.get(one_key);
+    REQUIRE(false);
+  }
+  catch (std::out_of_range&) { REQUIRE(true); }
+  catch (...) { REQUIRE(false); }
+
+  tinylfu_cache.insert(one_key, one_value);
+  REQUIRE(tinylfu_cache.has(one_key) == true);
+  REQUIRE(tinylfu_cache.try_get(one_key, tmp) == true);
+  REQUIRE(tinylfu_cache.get(one_key) == one_value);
+  REQUIRE(tinylfu_cache.size() == 1);
+  REQUIRE(tinylfu_cache.empty() == false);
+
+  tinylfu_cache.insert(two_key, two_value);
+  REQUIRE(tinylfu_cache.has(two_key) == true);
+  REQUIRE(tinylfu_cache.try_get(two_key, tmp) == true);
+  REQUIRE(tinylfu_cache.get(two_key) == two_value);
+  REQUIRE(tinylfu_cache.size() == 2);
+  REQUIRE(tinylfu_cache.empty() == false);
+  REQUIRE(tinylfu_cache.has(one_key) == true);
+  REQUIRE(tinylfu_cache.try_get(one_key, tmp) == true);
+  REQUIRE(tinylfu_cache.get(one_key) == one_value);
+
+  tinylfu_cache.erase(three_key);
+  REQUIRE(tinylfu_cache.size() == 2);
+  REQUIRE(tinylfu_cache.empty() == false);
+  REQUIRE(tinylfu_cache.has(one_key) == true);
+  REQUIRE(tinylfu_cache.has(two_key) == true);
+
+  tinylfu_cache.erase(one_key);
+  REQUIRE(tinylfu_cache.size() == 1);
+  REQUIRE(tinylfu_cache.empty() == false);
+  REQUIRE(tinylfu_cache.has(one_key) == false);
+  REQUIRE(tinylfu_cache.has(two_key) == true);
+
+  tinylfu_cache.clear();
+  REQUIRE(tinylfu_cache.size() == 0);
+  REQUIRE(tinylfu_cache.empty() == true);
+  REQUIRE(tinylfu_cache.has(one_key) == false);
+  REQUIRE(tinylfu_cache.has(two_key) == false);
+
+
+  tinylfu_cache.insert(one_key, one_value);
+  REQUIRE(tinylfu_cache.has(one_key) == true);
+
+  tinylfu_cache.insert(two_key, two_value);
+  REQUIRE(tinylfu_cache.has(two_key) == true);
+  REQUIRE(tinylfu_cache.has(one_key) == true);
+
+  // the second key leaving the window isn't used more often than the first key
+  tinylfu_cache.insert(three_key, three_value);
+  REQUIRE(tinylfu_cache.has(three_key) == true);
+  REQUIRE(tinylfu_cache.has(two_key) == false);
+  REQUIRE(tinylfu_cache.has(one_key) == true);
+
+  // the third key is used more often than the first key
+  REQUIRE(tinylfu_cache.get(three_key) == three_value);
+  REQUIRE(tinylfu_cache.get(three_key) == three_value);
+  REQUIRE(tinylfu_cache.touch(three_key) == true);
+
+  tinylfu_cache.insert(four_key, four_value);
+  REQUIRE(tinylfu_cache.has(four_key) == true);
+  REQUIRE(tinylfu_cache.has(three_key) == true);
+  REQUIRE(tinylfu_cache.has(two_key) == false);
+  REQUIRE(tinylfu_cache.has(one_key) == false);
+
+  // frequently used keys survive a scan over many keys used only once
+  const size_t scan_cache_size = 100;
+  const key_type hot_keys = 50;
+  cpp_cache::tinylfu_cache<key_type, value_type, scan_cache_size> scan_cache;
+
+  for (key_type key = 0; key < hot_keys; ++key)
+    scan_cache.insert(key, std::to_string(key));
+
+  for (int use = 0; use < 5; ++use)
+  {
+    for (key_type key = 0; key < hot_keys; ++key)
+      REQUIRE(scan_cache.touch(key) == true);
+  }
+
+  for (key_type key = 1000; key < 2000; ++key)
+    scan_cache.insert(key, std::to_string(key));
+
+  REQUIRE(scan_cache.size() == scan_cache_size);
+  for (key_type key = 0; key < hot_keys; ++key)
+    REQUIRE(scan_cache.has(key) == true);
+}
@@ -17,12 +17,38 @@
  *
  */
 
+#include <algorithm>
+#include <chrono>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include <catch.hpp>
 
 #include <cpp-cache/ttl-cache.h>
 
+namespace
+{
+  // clock which only moves when it is advanced so that expiring keys can be
+  // tested without sleeping
+  struct manual_clock
+  {
+    using duration = std::chrono::milliseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<manual_clock>;
+    static constexpr bool is_steady = true;
+
+    static time_point now() { return time_point(duration(now_ms)); }
+
+    static void advance_to(rep ms) { now_ms = ms; }
+
+    static rep now_ms;
+  };
+
+  manual_clock::rep manual_clock::now_ms = 0;
+}
+
 TEST_CASE("ttl", "[ttl]")
 {
   using key_type = int;
@@ -163,4 +189,94 @@ TEST_CASE("ttl", "[ttl]")
   std::this_thread::sleep_for(std::chrono::duration<int, std::milli>(ttl_max_age_ms));
 
   REQUIRE(ttl_cache.has(one_key) == false);
+
+  // keys with different time-to-live expire independently of each other
+  const key_type key_count = 8;
+  const size_t key_age_ms = ttl_max_age_ms / 4;
+  for (key_type key = 1; key <= key_count; ++key)
+    ttl_cache.insert(key, std::to_string(key), static_cast<ttl_cache_t::age_type>(key * key_age_ms));
+  REQUIRE(ttl_cache.size() == static_cast<size_t>(key_count));
+
+  std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(4.5 * key_age_ms));
+
+  for (key_type key = 1; key <= 3; ++key)
+    REQUIRE(ttl_cache.has(key) == false);
+  for (key_type key = 6; key <= key_count; ++key)
+    REQUIRE(ttl_cache.has(key) == true);
+
+  std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(5 * key_age_ms));
+
+  REQUIRE(ttl_cache.empty() == true);
+}
+
+TEST_CASE("ttl timing wheel", "[ttl]")
+{
+  using key_type = int;
+  using value_type = std::string;
+  using ttl_policy = cpp_cache::policy::ttl<key_type, 1000, cpp_cache::policy::none<key_type, size_t>, manual_clock>;
+  using ttl_cache_t = cpp_cache::cache<key_type, value_type, ttl_policy, cpp_cache::storage::map<key_type, value_type>>;
+
+  manual_clock::advance_to(0);
+  ttl_cache_t ttl_cache;
+
+  SECTION("expiry order")
+  {
+    // the maximum ages cover every level of the timing wheel and keys beyond
+    // its range which are parked and rescheduled later
+    const std::vector<std::pair<key_type, size_t>> keys = {
+      { 1, 10 },          // level 0
+      { 2, 300 },         // level 1
+      { 3, 1000 },        // level 1
+      { 4, 5000 },        // level 2
+      { 5, 100000 },      // level 2
+      { 6, 1000000 },     // level 3
+      { 7, 10000000 },    // level 3
+      { 8, 20000000 },    // beyond the range of the timing wheel
+      { 9, 50000000 }     // beyond the range of the timing wheel
+    };
+
+    for (const auto& key : keys)
+      ttl_cache.insert(key.first, std::to_string(key.first), key.second);
+    REQUIRE(ttl_cache.size() == keys.size());
+
+    // every key is still cached right before its end time and has expired
+    // right after it while all keys with a later end time are still cached
+    for (size_t index = 0; index < keys.size(); ++index)
+    {
+      const manual_clock::rep end_ms = static_cast<manual_clock::rep>(keys[index].second);
+
+      manual_clock::advance_to(end_ms - 1);
+      REQUIRE(ttl_cache.size() == keys.size() - index);
+      REQUIRE(ttl_cache.has(keys[index].first) == true);
+
+      manual_clock::advance_to(end_ms + 1);
+      REQUIRE(ttl_cache.has(keys[index].first) == false);
+      for (size_t later = index + 1; later < keys.size(); ++later)
+        REQUIRE(ttl_cache.has(keys[later].first) == true);
+    }
+
+    REQUIRE(ttl_cache.empty() == true);
+  }
+
+  SECTION("eviction order")
+  {
+    // move past the first cascade of the second level
+    manual_clock::advance_to(100);
+    REQUIRE(ttl_cache.empty() == true);
+
+    // the first key wraps around into the current slot of the second level
+    // whereas the second key expires much sooner
+    ttl_cache.insert(1, "one", static_cast<size_t>(4080));
+    ttl_cache.insert(2, "two", static_cast<size_t>(200));
+    ttl_cache.insert(3, "three", static_cast<size_t>(100000));
+
+    ttl_cache.set_max_weight(2);
+    REQUIRE(ttl_cache.has(2) == false);
+    REQUIRE(ttl_cache.has(1) == true);
+    REQUIRE(ttl_cache.has(3) == true);
+
+    ttl_cache.set_max_weight(1);
+    REQUIRE(ttl_cache.has(1) == false);
+    REQUIRE(ttl_cache.has(3) == true);
+  }
 }
@@ -0,0 +1,70 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cpp-signals; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+
+#include <catch.hpp>
+
+#include <cpp-cache/two-q-cache.h>
+
+TEST_CASE("two_q", "[two_q]")
+{
+  using key_type = int;
+  using value_type = std::string;
+  const size_t cache_size = 8;
+
+  cpp_cache::two_q_cache<key_type, value_type, cache_size> two_q_cache;
+
+  REQUIRE(two_q_cache.max_size() == cache_size);
+  REQUIRE(two_q_cache.empty() == true);
+  REQUIRE(two_q_cache.touch(1) == false);
+
+  for (key_type key = 1; key <= 8; ++key)
+    two_q_cache.insert(key, std::to_string(key));
+  REQUIRE(two_q_cache.size() == 8);
+
+  // touching a key in A1in doesn't protect it
+  REQUIRE(two_q_cache.get(1) == "1");
+  two_q_cache.insert(9, "9");
+  REQUIRE(two_q_cache.size() == 8);
+  REQUIRE(two_q_cache.has(1) == false);
+  REQUIRE(two_q_cache.has(2) == true);
+
+  // the evicted key is remembered in A1out and inserted into Am
+  two_q_cache.insert(1, "1");
+  REQUIRE(two_q_cache.has(1) == true);
+  REQUIRE(two_q_cache.has(2) == false);
+
+  // a scan only goes through A1in
+  for (key_type key = 10; key <= 100; ++key)
+    two_q_cache.insert(key, std::to_string(key));
+  REQUIRE(two_q_cache.size() == 8);
+  REQUIRE(two_q_cache.has(1) == true);
+  REQUIRE(two_q_cache.has(93) == false);
+  REQUIRE(two_q_cache.has(94) == true);
+  REQUIRE(two_q_cache.has(100) == true);
+
+  two_q_cache.erase(1);
+  REQUIRE(two_q_cache.size() == 7);
+  REQUIRE(two_q_cache.has(1) == false);
+
+  two_q_cache.clear();
+  REQUIRE(two_q_cache.empty() == true);
+  REQUIRE(two_q_cache.has(100) == false);
+}
@@ -0,0 +1,162 @@
+/*
+ *  Copyright (C) Sascha Montellese
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with cpp-signals; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string>
+
+#include <catch.hpp>
+
+#include <cpp-cache/entry-cache.h>
+#include <cpp-cache/lru-cache.h>
+#include <cpp-cache/ttl-cache.h>
+
+namespace
+{
+  struct string_weigher
+  {
+    size_t operator()(int, const std::string& value) const { return value.size(); }
+  };
+}
+
+TEST_CASE("weight", "[weight]")
+{
+  using key_type = int;
+  using value_type = std::string;
+  const size_t cache_size = 10;
+  const size_t cache_weight = 10;
+
+  const key_type one_key = 1;
+  const value_type one_value = "1111";
+  const key_type two_key = 2;
+  const value_type two_value = "2222";
+  const key_type three_key = 3;
+  const value_type three_value = "33";
+  const key_type four_key = 4;
+  const value_type four_value = "4";
+
+  cpp_cache::lru_cache<key_type, value_type, cache_size, cpp_cache::storage::map<key_type, value_type>, cpp_cache::no_locking, string_weigher> lru_cache;
+  lru_cache.set_max_weight(cache_weight);
+
+  REQUIRE(lru_cache.max_weight() == cache_weight);
+  REQUIRE(lru_cache.weight() == 0);
+
+  REQUIRE(lru_cache.insert(one_key, one_value) == true);
+  REQUIRE(lru_cache.insert(two_key, two_value) == true);
+  REQUIRE(lru_cache.insert(three_key, three_value) == true);
+  REQUIRE(lru_cache.weight() == 10);
+  REQUIRE(lru_cache.size() == 3);
+
+  // the least recently used key has to make room
+  REQUIRE(lru_cache.insert(four_key, four_value) == true);
+  REQUIRE(lru_cache.weight() == 7);
+  REQUIRE(lru_cache.size() == 3);
+  REQUIRE(lru_cache.has(one_key) == false);
+
+  // values heavier than the maximum weight are rejected
+  REQUIRE(lru_cache.insert(one_key, "11111111111") == false);
+  REQUIRE(lru_cache.has(one_key) == false);
+  REQUIRE(lru_cache.weight() == 7);
+  REQUIRE(lru_cache.size() == 3);
+
+  // replacing a cached value with one heavier than the maximum weight drops
+  // the old value
+  REQUIRE(lru_cache.insert(four_key, "44444444444") == false);
+  REQUIRE(lru_cache.has(four_key) == false);
+  REQUIRE(lru_cache.weight() == 6);
+  REQUIRE(lru_cache.size() == 2);
+  REQUIRE(lru_cache.insert(four_key, four_value) == true);
+  REQUIRE(lru_cache.weight() == 7);
+  REQUIRE(lru_cache.size() == 3);
+
+  // replacing a value only counts the new weight
+  REQUIRE(lru_cache.insert(three_key, "333333") == true);
+  REQUIRE(lru_cache.weight() == 7);
+  REQUIRE(lru_cache.size() == 2);
+  REQUIRE(lru_cache.has(two_key) == false);
+  REQUIRE(lru_cache.get(three_key) == "333333");
+
+  REQUIRE(lru_cache.insert(three_key, three_value) == true);
+  REQUIRE(lru_cache.weight() == 3);
+
+  lru_cache.erase(three_key);
+  REQUIRE(lru_cache.weight() == 1);
+  REQUIRE(lru_cache.size() == 1);
+
+  // lowering the maximum weight expires keys
+  REQUIRE(lru_cache.insert(one_key, one_value) == true);
+  REQUIRE(lru_cache.insert(two_key, two_value) == true);
+  REQUIRE(lru_cache.weight() == 9);
+  lru_cache.set_max_weight(5);
+  REQUIRE(lru_cache.weight() == 4);
+  REQUIRE(lru_cache.size() == 1);
+  REQUIRE(lru_cache.has(two_key) == true);
+
+  lru_cache.clear();
+  REQUIRE(lru_cache.weight() == 0);
+  REQUIRE(lru_cache.empty() == true);
+
+  SECTION("unweighted")
+  {
+    cpp_cache::lru_cache<key_type, value_type, cache_size> unweighted_cache;
+    REQUIRE(unweighted_cache.insert(one_key, one_value) == true);
+    REQUIRE(unweighted_cache.insert(two_key, two_value) == true);
+    REQUIRE(unweighted_cache.insert(three_key, three_value) == true);
+
+    // without a weigher the weight is the number of cached values
+    REQUIRE(unweighted_cache.weight() == 3);
+
+    unweighted_cache.set_max_weight(2);
+    REQUIRE(unweighted_cache.weight() == 2);
+    REQUIRE(unweighted_cache.has(one_key) == false);
+
+    REQUIRE(unweighted_cache.insert(four_key, four_value) == true);
+    REQUIRE(unweighted_cache.size() == 2);
+    REQUIRE(unweighted_cache.has(two_key) == false);
+  }
+
+  SECTION("ttl")
+  {
+    cpp_cache::ttl_cache<key_type, value_type, 10000, cpp_cache::storage::map<key_type, value_type>, cpp_cache::no_locking, string_weigher> ttl_cache;
+    ttl_cache.set_max_weight(cache_weight);
+
+    REQUIRE(ttl_cache.insert(one_key, one_value, static_cast<size_t>(1000)) == true);
+    REQUIRE(ttl_cache.insert(two_key, two_value, static_cast<size_t>(9000)) == true);
+    REQUIRE(ttl_cache.insert(three_key, three_value) == true);
+
+    // the key closest to expiring has to make room
+    REQUIRE(ttl_cache.insert(four_key, four_value) == true);
+    REQUIRE(ttl_cache.weight() == 7);
+    REQUIRE(ttl_cache.has(one_key) == false);
+    REQUIRE(ttl_cache.has(two_key) == true);
+  }
+
+  SECTION("entry")
+  {
+    cpp_cache::entry_lru_cache<key_type, value_type, cache_size, cpp_cache::no_locking, string_weigher> entry_cache;
+    entry_cache.set_max_weight(cache_weight);
+
+    REQUIRE(entry_cache.insert(one_key, one_value) == true);
+    REQUIRE(entry_cache.insert(two_key, two_value) == true);
+    REQUIRE(entry_cache.insert(three_key, three_value) == true);
+    REQUIRE(entry_cache.insert(four_key, four_value) == true);
+    REQUIRE(entry_cache.weight() == 7);
+    REQUIRE(entry_cache.has(one_key) == false);
+
+    entry_cache.erase(two_key);
+    REQUIRE(entry_cache.weight() == 3);
+  }
+}